@@ -1,5 +1,7 @@
 #include "application.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -7,25 +9,129 @@
 #include <set>
 #include <stack>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "astar.h"
+#include "bidirectional_dijkstra.h"
+#include "building_matrix.h"
+#include "dijkstra_kernel.h"
 #include "dist.h"
+#include "frozen_graph.h"
 #include "graph.h"
+#include "id_interner.h"
 #include "json.hpp"
+#include "landmarks.h"
+#include "parallel.h"
+#include "search_workspace.h"
+#include "spatial_grid.h"
 
 
 using namespace std;
 
 double INF = numeric_limits<double>::max();
 
-  
+namespace {
+
+/// Buildings are linked to every waypoint within this many miles
+const double BUILDING_LINK_RADIUS = 0.036;
+
+/// @brief Append undirected edges between each building and every waypoint
+///        within `BUILDING_LINK_RADIUS` of it. Buildings are split across `threads` workers; each collects its
+///        links separately and the results are appended in building order, so
+///        the output does not depend on the thread count.
+void appendBuildingLinks(const vector<BuildingInfo>& buildings,
+                         const unordered_map<long long, Coordinates>& waypointMap,
+                         vector<tuple<long long, long long, double>>& edges,
+                         unsigned threads) {
+    // Bucket waypoints so each building only checks nearby cells
+    double maxAbsLat = 0;
+    for (const auto& building : buildings) {
+        maxAbsLat = max(maxAbsLat, fabs(building.location.lat));
+    }
+    for (const auto& [waypointId, location] : waypointMap) {
+        maxAbsLat = max(maxAbsLat, fabs(location.lat));
+    }
+    spatial_grid<long long> grid(BUILDING_LINK_RADIUS, maxAbsLat);
+    for (const auto& [waypointId, location] : waypointMap) {
+        grid.insert(waypointId, location);
+    }
+
+    // Connect each building to nearby waypoints within 0.036 miles
+    vector<vector<pair<long long, double>>> links(buildings.size());
+    parallelFor(buildings.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            const BuildingInfo& building = buildings[b];
+            auto link = [&](long long waypointId, Coordinates location) {
+                double distance = distBetween2Points(building.location, location);
+                if (distance <= BUILDING_LINK_RADIUS) {
+                    links[b].emplace_back(waypointId, distance);
+                }
+            };
+            if (grid.covers(building.location)) {
+                grid.forEachCandidate(building.location, link);
+            } else {
+                // Degenerate coordinates (poles, antimeridian): check everything
+                for (const auto& [waypointId, location] : waypointMap) {
+                    link(waypointId, location);
+                }
+            }
+        }
+    });
+
+    for (size_t b = 0; b < buildings.size(); b++) {
+        for (const auto& [waypointId, distance] : links[b]) {
+            // Add undirected edges between the building and the waypoint
+            edges.emplace_back(buildings[b].id, waypointId, distance);
+            edges.emplace_back(waypointId, buildings[b].id, distance);
+        }
+    }
+}
+
+}  // namespace
+
 void buildGraph(istream& input, graph<long long, double>& G, vector<BuildingInfo>& buildings) {
+    id_interner<long long> ids;
+    buildGraph(input, G, buildings, ids);
+}
+
+template <typename StorageT>
+void buildGraph(istream& input, graph<long long, double, StorageT>& G,
+                vector<BuildingInfo>& buildings, id_interner<long long>& ids) {
+    vector<Coordinates> coords;
+    buildGraph(input, G, buildings, ids, coords);
+}
+
+template <typename StorageT>
+void buildGraph(istream& input, graph<long long, double, StorageT>& G,
+                vector<BuildingInfo>& buildings, id_interner<long long>& ids,
+                vector<Coordinates>& coords, BuildOptions options) {
     using json = nlohmann::json;
     json data;
     input >> data;
 
+    size_t numBuildings = data.contains("buildings") ? data["buildings"].size() : 0;
+    size_t numWaypoints = data.contains("waypoints") ? data["waypoints"].size() : 0;
+    size_t numSegments = 0;
+    if (data.contains("footways")) {
+        for (const auto& footway : data["footways"]) {
+            numSegments += footway.empty() ? 0 : footway.size() - 1;
+        }
+    }
+    G.reserve(numBuildings + numWaypoints, 2 * numSegments);
+    ids.reserve(numBuildings + numWaypoints);
+    coords.reserve(ids.size() + numBuildings + numWaypoints);
+    auto setCoords = [&](long long id, Coordinates c) {
+        uint32_t i = ids.intern(id);
+        if (coords.size() <= i) {
+            coords.resize(i + 1);
+        }
+        coords[i] = c;
+    };
+    buildings.reserve(buildings.size() + numBuildings);
+
     // Parse buildings and add them to the list
     if (data.contains("buildings")) {
         for (const auto& building : data["buildings"]) {
@@ -38,51 +144,309 @@ void buildGraph(istream& input, graph<long long, double>& G, vector<BuildingInfo
 
             // Add the building as a vertex in the graph
             G.addVertex(id);
+            setCoords(id, Coordinates(lat, lon));
         }
     }
 
     // Parse waypoints and add them as vertices
     unordered_map<long long, Coordinates> waypointMap;
+    waypointMap.reserve(numWaypoints);
     if (data.contains("waypoints")) {
         for (const auto& waypoint : data["waypoints"]) {
             long long id = waypoint["id"];
             double lat = waypoint["lat"];
             double lon = waypoint["lon"];
             G.addVertex(id);
+            setCoords(id, Coordinates(lat, lon));
             waypointMap[id] = Coordinates(lat, lon); // Store for distance calculations
         }
     }
 
-    // Parse footways and add edges between consecutive waypoints
-    if (data.contains("footways")) {
-        for (const auto& footway : data["footways"]) {
-            for (size_t i = 0; i < footway.size() - 1; i++) {
-                long long from = footway[i];
-                long long to = footway[i + 1];
+    // Unknown ids fall back to (0, 0); addEdges drops edges whose endpoints
+    // are not vertices
+    auto coordsOf = [&](long long id) {
+        auto it = waypointMap.find(id);
+        return it == waypointMap.end() ? Coordinates() : it->second;
+    };
 
-                // Calculate distance between waypoints
-                double distance = distBetween2Points(waypointMap[from], waypointMap[to]);
+    // Collect every edge, then insert them in one bulk pass
+    vector<tuple<long long, long long, double>> edges;
+    edges.reserve(2 * numSegments);
 
-                // Add undirected edges
-                G.addEdge(from, to, distance);
-                G.addEdge(to, from, distance);
+    // Parse footways into consecutive waypoint pairs
+    vector<pair<long long, long long>> segments;
+    segments.reserve(numSegments);
+    if (data.contains("footways")) {
+        for (const auto& footway : data["footways"]) {
+            for (size_t i = 0; i + 1 < footway.size(); i++) {
+                segments.emplace_back(footway[i].get<long long>(),
+                                      footway[i + 1].get<long long>());
             }
         }
     }
 
-    // Connect each building to nearby waypoints within 0.036 miles
-    for (const auto& building : buildings) {
-        for (const auto& [waypointId, coords] : waypointMap) {
-            double distance = distBetween2Points(building.location, coords);
-            if (distance <= 0.036) {
-                // Add undirected edges between the building and the waypoint
-                G.addEdge(building.id, waypointId, distance);
-                G.addEdge(waypointId, building.id, distance);
-            }
+    // Calculate distance between waypoints, split across threads
+    vector<double> distances(segments.size());
+    parallelFor(segments.size(), options.threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            distances[i] = distBetween2Points(coordsOf(segments[i].first),
+                                              coordsOf(segments[i].second));
+        }
+    });
+
+    // Add undirected edges, in footway order
+    for (size_t i = 0; i < segments.size(); i++) {
+        auto [from, to] = segments[i];
+        edges.emplace_back(from, to, distances[i]);
+        edges.emplace_back(to, from, distances[i]);
+    }
+
+    appendBuildingLinks(buildings, waypointMap, edges, options.threads);
+    G.addEdges(edges);
+}
+
+template void buildGraph(istream&, graph<long long, double, node_hash_storage>&,
+                         vector<BuildingInfo>&, id_interner<long long>&);
+template void buildGraph(istream&, graph<long long, double, flat_hash_storage>&,
+                         vector<BuildingInfo>&, id_interner<long long>&);
+template void buildGraph(istream&, graph<long long, double, node_hash_storage>&,
+                         vector<BuildingInfo>&, id_interner<long long>&,
+                         vector<Coordinates>&, BuildOptions);
+template void buildGraph(istream&, graph<long long, double, flat_hash_storage>&,
+                         vector<BuildingInfo>&, id_interner<long long>&,
+                         vector<Coordinates>&, BuildOptions);
+
+namespace {
+
+/// @brief SAX handler for map JSON. Vertices, buildings and footway edges are
+///        added to the graph as soon as each record closes, so only the
+///        current record is held in memory besides the graph itself.
+template <typename StorageT>
+class MapSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+ public:
+  MapSaxHandler(graph<long long, double, StorageT>& G,
+                vector<BuildingInfo>& buildings, id_interner<long long>& ids,
+                vector<Coordinates>& coords, BuildOptions options)
+      : G(G), buildings(buildings), ids(ids), coords(coords), options(options) {
+  }
+
+  /// @brief Edges that could not be emitted while streaming: footways seen
+  ///        before the waypoints they reference, and building links (which
+  ///        need every waypoint). Call once parsing has succeeded.
+  void finish() {
+    for (const vector<long long>& footway : pendingFootways) {
+      for (size_t i = 0; i + 1 < footway.size(); i++) {
+        addFootwayEdge(footway[i], footway[i + 1]);
+      }
+    }
+    pendingFootways.clear();
+
+    vector<tuple<long long, long long, double>> edges;
+    appendBuildingLinks(buildings, waypointMap, edges, options.threads);
+    G.addEdges(edges);
+  }
+
+  bool null() override {
+    return true;
+  }
+
+  bool boolean(bool) override {
+    return true;
+  }
+
+  bool number_integer(number_integer_t val) override {
+    return number((long long)val, (double)val);
+  }
+
+  bool number_unsigned(number_unsigned_t val) override {
+    return number((long long)val, (double)val);
+  }
+
+  bool number_float(number_float_t val, const string_t&) override {
+    return number((long long)val, val);
+  }
+
+  bool string(string_t& val) override {
+    if (inRecord() && section == Section::Buildings) {
+      if (field == "name") {
+        record.name = val;
+      } else if (field == "abbr") {
+        record.abbr = val;
+      }
+    }
+    return true;
+  }
+
+  bool binary(binary_t&) override {
+    return true;
+  }
+
+  bool start_object(size_t) override {
+    depth++;
+    if (depth == 3 && section != Section::None) {
+      record = Record();
+    }
+    return true;
+  }
+
+  bool key(string_t& val) override {
+    if (depth == 1) {
+      section = val == "buildings"   ? Section::Buildings
+                : val == "waypoints" ? Section::Waypoints
+                : val == "footways"  ? Section::Footways
+                                     : Section::None;
+    } else if (inRecord()) {
+      field = val;
+    }
+    return true;
+  }
+
+  bool end_object() override {
+    if (inRecord()) {
+      if (section == Section::Buildings) {
+        buildings.emplace_back(record.id, Coordinates(record.lat, record.lon),
+                               record.name, record.abbr);
+        addVertex(record.id, Coordinates(record.lat, record.lon));
+      } else if (section == Section::Waypoints) {
+        addVertex(record.id, Coordinates(record.lat, record.lon));
+        waypointMap[record.id] = Coordinates(record.lat, record.lon);
+      }
+    }
+    depth--;
+    return true;
+  }
+
+  bool start_array(size_t) override {
+    depth++;
+    if (depth == 3 && section == Section::Footways) {
+      havePrevious = false;
+      if (!waypointsSeen) {
+        pendingFootways.emplace_back();
+      }
+    }
+    return true;
+  }
+
+  bool end_array() override {
+    if (depth == 2 && section == Section::Waypoints) {
+      waypointsSeen = true;
+    }
+    depth--;
+    return true;
+  }
+
+  bool parse_error(size_t, const std::string&,
+                   const nlohmann::detail::exception&) override {
+    return false;
+  }
+
+ private:
+  enum class Section { None, Buildings, Waypoints, Footways };
+
+  struct Record {
+    long long id = 0;
+    double lat = 0;
+    double lon = 0;
+    std::string name;
+    std::string abbr;
+  };
+
+  graph<long long, double, StorageT>& G;
+  vector<BuildingInfo>& buildings;
+  id_interner<long long>& ids;
+  vector<Coordinates>& coords;
+  BuildOptions options;
+  unordered_map<long long, Coordinates> waypointMap;
+
+  // depth 1: top-level object; 2: section array; 3: one record / footway
+  int depth = 0;
+  Section section = Section::None;
+  std::string field;
+  Record record;
+
+  bool waypointsSeen = false;
+  bool havePrevious = false;
+  long long previous = 0;
+  vector<vector<long long>> pendingFootways;
+
+  bool inRecord() const {
+    return depth == 3 && (section == Section::Buildings ||
+                          section == Section::Waypoints);
+  }
+
+  bool number(long long asInteger, double asFloat) {
+    if (inRecord()) {
+      if (field == "id") {
+        record.id = asInteger;
+      } else if (field == "lat") {
+        record.lat = asFloat;
+      } else if (field == "lon") {
+        record.lon = asFloat;
+      }
+    } else if (depth == 3 && section == Section::Footways) {
+      if (!waypointsSeen) {
+        pendingFootways.back().push_back(asInteger);
+      } else {
+        if (havePrevious) {
+          addFootwayEdge(previous, asInteger);
         }
+        previous = asInteger;
+        havePrevious = true;
+      }
+    }
+    return true;
+  }
+
+  void addVertex(long long id, Coordinates location) {
+    G.addVertex(id);
+    uint32_t i = ids.intern(id);
+    if (coords.size() <= i) {
+      coords.resize(i + 1);
     }
+    coords[i] = location;
+  }
+
+  void addFootwayEdge(long long from, long long to) {
+    auto coordsOf = [&](long long id) {
+      auto it = waypointMap.find(id);
+      return it == waypointMap.end() ? Coordinates() : it->second;
+    };
+    double distance = distBetween2Points(coordsOf(from), coordsOf(to));
+    G.addEdge(from, to, distance);
+    G.addEdge(to, from, distance);
+  }
+};
+
+}  // namespace
+
+bool buildGraphStreaming(istream& input, graph<long long, double>& G,
+                         vector<BuildingInfo>& buildings) {
+  id_interner<long long> ids;
+  vector<Coordinates> coords;
+  return buildGraphStreaming(input, G, buildings, ids, coords);
 }
 
+template <typename StorageT>
+bool buildGraphStreaming(istream& input, graph<long long, double, StorageT>& G,
+                         vector<BuildingInfo>& buildings,
+                         id_interner<long long>& ids,
+                         vector<Coordinates>& coords, BuildOptions options) {
+  MapSaxHandler<StorageT> handler(G, buildings, ids, coords, options);
+  if (!nlohmann::json::sax_parse(input, &handler)) {
+    return false;
+  }
+  handler.finish();
+  return true;
+}
+
+template bool buildGraphStreaming(istream&,
+                                  graph<long long, double, node_hash_storage>&,
+                                  vector<BuildingInfo>&, id_interner<long long>&,
+                                  vector<Coordinates>&, BuildOptions);
+template bool buildGraphStreaming(istream&,
+                                  graph<long long, double, flat_hash_storage>&,
+                                  vector<BuildingInfo>&, id_interner<long long>&,
+                                  vector<Coordinates>&, BuildOptions);
 
 BuildingInfo getBuildingInfo(const vector<BuildingInfo>& buildings,
                              const string& query) { 
@@ -112,55 +476,69 @@ BuildingInfo getClosestBuilding(const vector<BuildingInfo>& buildings,
   return ret;
 }
 
-vector<long long> dijkstra(const graph<long long, double>& G, long long start,
-                           long long target, const set<long long>& ignoreNodes) {
+namespace {
+
+// Body of the hash-map graph `dijkstra`, with or without statistics
+template <typename StatsT>
+vector<long long> hashGraphDijkstra(const graph<long long, double>& G,
+                                    long long start, long long target,
+                                    const set<long long>& ignoreNodes,
+                                    StatsT& stats) {
+    stats.start();
     unordered_map<long long, double> distances;
     unordered_map<long long, long long> predecessors;
     priority_queue<pair<double, long long>, vector<pair<double, long long>>, greater<>> pq;
 
-    for (const auto& i : G.getVertices()) {
-        distances[i] = INF;
-    }
+    // Vertices not in `distances` have not been reached yet
+    auto distanceTo = [&distances](long long v) {
+        auto it = distances.find(v);
+        return it == distances.end() ? INF : it->second;
+    };
 
     distances[start] = 0;
     pq.emplace(0, start);
+    stats.onPush(pq.size());
 
     while (!pq.empty()) {
-        auto [currentDist, currentVertex] = pq.top();
+        double currentDist = pq.top().first;
+        long long currentVertex = pq.top().second;
         pq.pop();
+        stats.onPop();
 
         if (currentVertex != start && currentVertex != target && ignoreNodes.count(currentVertex)) {
             continue;
         }
 
+        // Stale entry; this vertex was already settled at a shorter distance
+        if (currentDist > distanceTo(currentVertex)) {
+            stats.onStalePop();
+            continue;
+        }
+        stats.onSettle();
+
         if (currentVertex == target) {
             break;
         }
 
-        for (const auto& i : G.neighbors(currentVertex)) {
-            
+        G.forEachOutEdge(currentVertex, [&](long long i, double wght) {
             if (i != start && i != target && ignoreNodes.count(i)) {
-              continue; 
-            }
-
-            double wght;
-
-            if (!G.getWeight(currentVertex, i, wght)) {
-              continue; 
+              return;
             }
 
             double newDist = currentDist + wght;
+            stats.onRelax();
 
-            if (newDist < distances[i]) {
+            if (newDist < distanceTo(i)) {
                 distances[i] = newDist;
                 predecessors[i] = currentVertex;
                 pq.emplace(newDist, i);
+                stats.onPush(pq.size());
             }
-        }
+        });
     }
+    stats.stop();
 
-    
-    if (distances[target] == INF) {
+    if (distanceTo(target) == INF) {
       return {}; 
     }
 
@@ -177,8 +555,378 @@ vector<long long> dijkstra(const graph<long long, double>& G, long long start,
     return rote;
 }
 
+}  // namespace
+
+vector<long long> dijkstra(const graph<long long, double>& G, long long start,
+                           long long target, const set<long long>& ignoreNodes) {
+  NoStats stats;
+  return hashGraphDijkstra(G, start, target, ignoreNodes, stats);
+}
+
+vector<long long> dijkstra(const graph<long long, double>& G, long long start,
+                           long long target, const set<long long>& ignoreNodes,
+                           SearchStats& stats) {
+  return hashGraphDijkstra(G, start, target, ignoreNodes, stats);
+}
+
+namespace {
+
+using FG = frozen_graph<long long, double>;
+
+// Flag `ignoreNodes` in a freshly reset `workspace`
+void markIgnored(const FG& G, const set<long long>& ignoreNodes,
+                 SearchWorkspace& workspace) {
+  for (long long id : ignoreNodes) {
+    uint32_t i = G.indexOf(id);
+    if (i != FG::NONE) {
+      workspace.setIgnored(i, true);
+    }
+  }
+}
+
+// Path to `t` out of a search from `s` that recorded predecessors
+vector<uint32_t> unpackPath(const SearchWorkspace& workspace, uint32_t s,
+                            uint32_t t) {
+  if (workspace.distance(t) == SearchWorkspace::INF) {
+    return {};
+  }
+  vector<uint32_t> path;
+  for (uint32_t at = t; at != s; at = workspace.predecessor(at)) {
+    path.push_back(at);
+  }
+  path.push_back(s);
+  reverse(path.begin(), path.end());
+  return path;
+}
+
+// Point-to-point search shared by the `set` and `VertexMask` overloads
+template <typename ExclusionT, typename StatsT = NoStats>
+vector<uint32_t> pointToPoint(const FG& G, uint32_t s, uint32_t t,
+                              SearchWorkspace& workspace,
+                              const ExclusionT& exclusion,
+                              StatsT&& stats = NoStats()) {
+  StopAtTarget termination{t};
+  dijkstraSearch(G, s, workspace, workspace.heap(), exclusion, termination,
+                 RecordPredecessors(), stats);
+  return unpackPath(workspace, s, t);
+}
+
+// dijkstraByIndex with a set of node IDs, with or without statistics
+template <typename StatsT>
+vector<uint32_t> pointToPointIgnoring(const FG& G, uint32_t s, uint32_t t,
+                                      const set<long long>& ignoreNodes,
+                                      SearchWorkspace& workspace,
+                                      StatsT& stats) {
+  size_t n = G.numVertices();
+  if (s >= n || t >= n) {
+    return {};
+  }
+
+  workspace.reset(n);
+  if (ignoreNodes.empty()) {
+    return pointToPoint(G, s, t, workspace, NoExclusion(), stats);
+  }
+  markIgnored(G, ignoreNodes, workspace);
+  return pointToPoint(G, s, t, workspace, ExcludeIgnored{workspace}, stats);
+}
+
+// One-to-many search shared by the `set` and `VertexMask` overloads
+template <typename ExclusionT, typename StatsT = NoStats>
+vector<vector<uint32_t>> oneToMany(const FG& G, uint32_t source,
+                                   const vector<uint32_t>& targets,
+                                   SearchDirection direction,
+                                   SearchWorkspace& workspace,
+                                   const ExclusionT& exclusion,
+                                   StatsT&& stats = NoStats()) {
+  size_t n = G.numVertices();
+  // An excluded target may end its own path but must not carry anyone
+  // else's, so it is reachable but never expanded
+  StopAfterTargets termination(targets, n);
+  if (direction == SearchDirection::Forward) {
+    dijkstraSearch<SearchDirection::Forward>(
+        G, source, workspace, workspace.heap(), exclusion, termination,
+        RecordPredecessors(), stats);
+  } else {
+    dijkstraSearch<SearchDirection::Backward>(
+        G, source, workspace, workspace.heap(), exclusion, termination,
+        RecordPredecessors(), stats);
+  }
+
+  vector<vector<uint32_t>> paths(targets.size());
+  for (size_t i = 0; i < targets.size(); i++) {
+    uint32_t t = targets[i];
+    if (t >= n || !workspace.settled(t)) {
+      continue;
+    }
+    // Predecessors point back toward `source`: in a backward search that is
+    // the direction of travel
+    for (uint32_t at = t; at != FG::NONE; at = workspace.predecessor(at)) {
+      paths[i].push_back(at);
+    }
+    if (direction == SearchDirection::Forward) {
+      reverse(paths[i].begin(), paths[i].end());
+    }
+  }
+  return paths;
+}
+
+// Translate dense paths back to node IDs
+vector<long long> toNodeIds(const FG& G, const vector<uint32_t>& dense) {
+  vector<long long> path;
+  path.reserve(dense.size());
+  for (uint32_t u : dense) {
+    path.push_back(G.vertexAt(u));
+  }
+  return path;
+}
 
+}  // namespace
 
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t s, uint32_t t,
+                                 const set<long long>& ignoreNodes,
+                                 SearchWorkspace& workspace) {
+  NoStats stats;
+  return pointToPointIgnoring(G, s, t, ignoreNodes, workspace, stats);
+}
+
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t s, uint32_t t,
+                                 const set<long long>& ignoreNodes,
+                                 SearchWorkspace& workspace,
+                                 SearchStats& stats) {
+  return pointToPointIgnoring(G, s, t, ignoreNodes, workspace, stats);
+}
+
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t s, uint32_t t,
+                                 const VertexMask& excluded,
+                                 SearchWorkspace& workspace) {
+  size_t n = G.numVertices();
+  if (s >= n || t >= n) {
+    return {};
+  }
+
+  workspace.reset(n);
+  return pointToPoint(G, s, t, workspace, ExcludeMask{excluded});
+}
+
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t s, uint32_t t,
+                                 const set<long long>& ignoreNodes) {
+  // Each thread keeps one workspace, so back-to-back queries skip the O(V)
+  // setup
+  thread_local SearchWorkspace workspace;
+  return dijkstraByIndex(G, s, t, ignoreNodes, workspace);
+}
+
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t s, uint32_t t,
+                                 const VertexMask& excluded) {
+  thread_local SearchWorkspace workspace;
+  return dijkstraByIndex(G, s, t, excluded, workspace);
+}
+
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const set<long long>& ignoreNodes,
+                           SearchWorkspace& workspace) {
+  return toNodeIds(G, dijkstraByIndex(G, G.indexOf(start), G.indexOf(target),
+                                      ignoreNodes, workspace));
+}
+
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const VertexMask& excluded,
+                           SearchWorkspace& workspace) {
+  return toNodeIds(G, dijkstraByIndex(G, G.indexOf(start), G.indexOf(target),
+                                      excluded, workspace));
+}
+
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const set<long long>& ignoreNodes) {
+  thread_local SearchWorkspace workspace;
+  return dijkstra(G, start, target, ignoreNodes, workspace);
+}
+
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const set<long long>& ignoreNodes,
+                           SearchStats& stats) {
+  thread_local SearchWorkspace workspace;
+  return toNodeIds(G, dijkstraByIndex(G, G.indexOf(start), G.indexOf(target),
+                                      ignoreNodes, workspace, stats));
+}
+
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const VertexMask& excluded) {
+  thread_local SearchWorkspace workspace;
+  return dijkstra(G, start, target, excluded, workspace);
+}
+
+double shortestDistanceByIndex(const frozen_graph<long long, double>& G,
+                               uint32_t s, uint32_t t,
+                               const set<long long>& ignoreNodes,
+                               SearchWorkspace& workspace) {
+  size_t n = G.numVertices();
+  if (s >= n || t >= n) {
+    return SearchWorkspace::INF;
+  }
+
+  workspace.reset(n);
+  StopAtTarget termination{t};
+  if (ignoreNodes.empty()) {
+    dijkstraSearch(G, s, workspace, workspace.heap(), NoExclusion(),
+                   termination, DistancesOnly());
+  } else {
+    markIgnored(G, ignoreNodes, workspace);
+    dijkstraSearch(G, s, workspace, workspace.heap(),
+                   ExcludeIgnored{workspace}, termination, DistancesOnly());
+  }
+  return workspace.distance(t);
+}
+
+double shortestDistanceByIndex(const frozen_graph<long long, double>& G,
+                               uint32_t s, uint32_t t,
+                               const VertexMask& excluded,
+                               SearchWorkspace& workspace) {
+  size_t n = G.numVertices();
+  if (s >= n || t >= n) {
+    return SearchWorkspace::INF;
+  }
+
+  workspace.reset(n);
+  StopAtTarget termination{t};
+  dijkstraSearch(G, s, workspace, workspace.heap(), ExcludeMask{excluded},
+                 termination, DistancesOnly());
+  return workspace.distance(t);
+}
+
+double shortestDistance(const frozen_graph<long long, double>& G,
+                        long long start, long long target,
+                        const set<long long>& ignoreNodes) {
+  thread_local SearchWorkspace workspace;
+  return shortestDistanceByIndex(G, G.indexOf(start), G.indexOf(target),
+                                 ignoreNodes, workspace);
+}
+
+double shortestDistance(const frozen_graph<long long, double>& G,
+                        long long start, long long target,
+                        const VertexMask& excluded) {
+  thread_local SearchWorkspace workspace;
+  return shortestDistanceByIndex(G, G.indexOf(start), G.indexOf(target),
+                                 excluded, workspace);
+}
+
+vector<vector<uint32_t>> dijkstraOneToManyByIndex(
+    const frozen_graph<long long, double>& G, uint32_t source,
+    const vector<uint32_t>& targets, const set<long long>& ignoreNodes,
+    SearchDirection direction, SearchWorkspace& workspace) {
+  size_t n = G.numVertices();
+  if (source >= n) {
+    return vector<vector<uint32_t>>(targets.size());
+  }
+
+  workspace.reset(n);
+  if (ignoreNodes.empty()) {
+    return oneToMany(G, source, targets, direction, workspace, NoExclusion());
+  }
+  markIgnored(G, ignoreNodes, workspace);
+  return oneToMany(G, source, targets, direction, workspace,
+                   ExcludeIgnored{workspace});
+}
+
+vector<vector<uint32_t>> dijkstraOneToManyByIndex(
+    const frozen_graph<long long, double>& G, uint32_t source,
+    const vector<uint32_t>& targets, const VertexMask& excluded,
+    SearchDirection direction, SearchWorkspace& workspace) {
+  size_t n = G.numVertices();
+  if (source >= n) {
+    return vector<vector<uint32_t>>(targets.size());
+  }
+
+  workspace.reset(n);
+  return oneToMany(G, source, targets, direction, workspace,
+                   ExcludeMask{excluded});
+}
+
+vector<vector<uint32_t>> dijkstraOneToManyByIndex(
+    const frozen_graph<long long, double>& G, uint32_t source,
+    const vector<uint32_t>& targets, const VertexMask& excluded,
+    SearchDirection direction, SearchWorkspace& workspace,
+    SearchStats& stats) {
+  size_t n = G.numVertices();
+  if (source >= n) {
+    return vector<vector<uint32_t>>(targets.size());
+  }
+
+  workspace.reset(n);
+  return oneToMany(G, source, targets, direction, workspace,
+                   ExcludeMask{excluded}, stats);
+}
+
+vector<vector<long long>> dijkstraOneToMany(
+    const frozen_graph<long long, double>& G, long long source,
+    const vector<long long>& targets, const set<long long>& ignoreNodes,
+    SearchDirection direction) {
+  thread_local SearchWorkspace workspace;
+  vector<uint32_t> denseTargets;
+  denseTargets.reserve(targets.size());
+  for (long long t : targets) {
+    denseTargets.push_back(G.indexOf(t));
+  }
+  vector<vector<uint32_t>> dense =
+      dijkstraOneToManyByIndex(G, G.indexOf(source), denseTargets,
+                               ignoreNodes, direction, workspace);
+  vector<vector<long long>> paths(dense.size());
+  for (size_t i = 0; i < dense.size(); i++) {
+    paths[i] = toNodeIds(G, dense[i]);
+  }
+  return paths;
+}
+
+void shortestPathTree(const frozen_graph<long long, double>& G,
+                      uint32_t source, const set<long long>& ignoreNodes,
+                      SearchWorkspace& workspace) {
+  size_t n = G.numVertices();
+  workspace.reset(n);
+  if (source >= n) {
+    return;
+  }
+  markIgnored(G, ignoreNodes, workspace);
+  ExploreAll termination;
+  dijkstraSearch(G, source, workspace, workspace.heap(),
+                 ExcludeIgnored{workspace}, termination, RecordPredecessors());
+}
+
+void shortestPathTree(const frozen_graph<long long, double>& G,
+                      uint32_t source, const VertexMask& excluded,
+                      SearchWorkspace& workspace) {
+  size_t n = G.numVertices();
+  workspace.reset(n);
+  if (source >= n) {
+    return;
+  }
+  ExploreAll termination;
+  dijkstraSearch(G, source, workspace, workspace.heap(), ExcludeMask{excluded},
+                 termination, RecordPredecessors());
+}
+
+vector<uint32_t> treePath(const SearchWorkspace& tree, uint32_t target) {
+  if (target >= tree.capacity() ||
+      tree.distance(target) == SearchWorkspace::INF) {
+    return {};
+  }
+  vector<uint32_t> path;
+  for (uint32_t at = target; at != SearchWorkspace::NONE;
+       at = tree.predecessor(at)) {
+    path.push_back(at);
+  }
+  reverse(path.begin(), path.end());
+  return path;
+}
 
 double pathLength(const graph<long long, double>& G,
                   const vector<long long>& path) {
@@ -194,6 +942,34 @@ double pathLength(const graph<long long, double>& G,
   return length;
 }
 
+double pathLength(const frozen_graph<long long, double>& G,
+                  const vector<long long>& path) {
+  double length = 0.0;
+  double weight;
+  for (size_t i = 0; i + 1 < path.size(); i++) {
+    bool res = G.getWeight(path.at(i), path.at(i + 1), weight);
+    if (!res) {
+      return -1;
+    }
+    length += weight;
+  }
+  return length;
+}
+
+double pathLength(const frozen_graph<long long, double>& G,
+                  const vector<uint32_t>& path) {
+  double length = 0.0;
+  double weight;
+  for (size_t i = 0; i + 1 < path.size(); i++) {
+    bool res = G.getWeightAt(path.at(i), path.at(i + 1), weight);
+    if (!res) {
+      return -1;
+    }
+    length += weight;
+  }
+  return length;
+}
+
 void outputPath(const vector<long long>& path) {
   for (size_t i = 0; i < path.size(); i++) {
     cout << path.at(i);
@@ -204,83 +980,304 @@ void outputPath(const vector<long long>& path) {
   cout << endl;
 }
 
+void outputPath(const vector<uint32_t>& path,
+                const id_interner<long long>& ids) {
+  for (size_t i = 0; i < path.size(); i++) {
+    cout << ids.at(path.at(i));
+    if (i != path.size() - 1) {
+      cout << "->";
+    }
+  }
+  cout << endl;
+}
+
+void outputStats(const SearchStats& stats) {
+  cout << "Search stats: " << stats.settled << " settled, " << stats.relaxed
+       << " edges relaxed, " << stats.pushes << " pushes, " << stats.pops
+       << " pops (" << stats.stalePops << " stale), max heap "
+       << stats.maxHeapSize << ", " << stats.milliseconds << " ms" << endl;
+}
+
+bool parseSearchAlgorithm(const string& name, SearchAlgorithm& algorithm) {
+  if (name == "dijkstra") {
+    algorithm = SearchAlgorithm::Dijkstra;
+  } else if (name == "astar") {
+    algorithm = SearchAlgorithm::AStar;
+  } else if (name == "bidirectional") {
+    algorithm = SearchAlgorithm::Bidirectional;
+  } else if (name == "alt") {
+    algorithm = SearchAlgorithm::ALT;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+vector<uint32_t> findPath(const frozen_graph<long long, double>& G,
+                          const VertexCoordinates& coords,
+                          const Landmarks& landmarks, uint32_t start,
+                          uint32_t target, const set<long long>& ignoreNodes,
+                          SearchAlgorithm algorithm) {
+  switch (algorithm) {
+    case SearchAlgorithm::AStar:
+      if (coords.coords.size() == G.numVertices()) {
+        return astarByIndex(G, coords, start, target, ignoreNodes);
+      }
+      break;
+    case SearchAlgorithm::Bidirectional:
+      return bidirectionalDijkstraByIndex(G, start, target, ignoreNodes);
+    case SearchAlgorithm::ALT:
+      if (landmarks.covers(G.numVertices())) {
+        return altSearchByIndex(G, landmarks, start, target, ignoreNodes);
+      }
+      break;
+    case SearchAlgorithm::Dijkstra:
+      break;
+  }
+  return dijkstraByIndex(G, start, target, ignoreNodes);
+}
+
+bool parseMeetingPoint(const string& name, MeetingPoint& meetingPoint) {
+  if (name == "center") {
+    meetingPoint = MeetingPoint::Center;
+  } else if (name == "minmax") {
+    meetingPoint = MeetingPoint::MinMax;
+  } else if (name == "minsum") {
+    meetingPoint = MeetingPoint::MinSum;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+int chooseMeetingBuilding(const frozen_graph<long long, double>& G,
+                          const vector<BuildingInfo>& buildings,
+                          const vector<SearchWorkspace>& trees,
+                          MeetingPoint objective) {
+  int best = -1;
+  pair<double, double> bestScore;
+  for (size_t i = 0; i < buildings.size(); i++) {
+    uint32_t v = G.indexOf(buildings[i].id);
+    if (v == frozen_graph<long long, double>::NONE) {
+      continue;
+    }
+
+    double longest = 0, total = 0;
+    bool reachable = true;
+    for (const SearchWorkspace& tree : trees) {
+      double d = v < tree.capacity() ? tree.distance(v) : SearchWorkspace::INF;
+      if (d == SearchWorkspace::INF) {
+        reachable = false;
+        break;
+      }
+      longest = max(longest, d);
+      total += d;
+    }
+    if (!reachable) {
+      continue;
+    }
+
+    pair<double, double> score = objective == MeetingPoint::MinSum
+                                     ? make_pair(total, longest)
+                                     : make_pair(longest, total);
+    if (best == -1 || score < bestScore) {
+      best = i;
+      bestScore = score;
+    }
+  }
+  return best;
+}
+
+MeetupPlan planMeetup(const frozen_graph<long long, double>& G,
+                      const vector<BuildingInfo>& buildings,
+                      const vector<uint32_t>& participants,
+                      const set<long long>& ignoreNodes,
+                      MeetingPoint objective, vector<SearchWorkspace>& trees,
+                      unsigned threads) {
+  // Every tree visits the whole graph, so building the mask costs little
+  return planMeetup(G, buildings, participants, VertexMask(G, ignoreNodes),
+                    objective, trees, threads);
+}
+
+MeetupPlan planMeetup(const frozen_graph<long long, double>& G,
+                      const vector<BuildingInfo>& buildings,
+                      const vector<uint32_t>& participants,
+                      const VertexMask& excluded, MeetingPoint objective,
+                      vector<SearchWorkspace>& trees, unsigned threads) {
+  trees.resize(participants.size());
+  parallelFor(participants.size(), threads, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      shortestPathTree(G, participants[i], excluded, trees[i]);
+    }
+  });
+
+  MeetupPlan plan;
+  plan.building = chooseMeetingBuilding(G, buildings, trees, objective);
+  if (plan.building != -1) {
+    uint32_t dest = G.indexOf(buildings[plan.building].id);
+    for (const SearchWorkspace& tree : trees) {
+      plan.paths.push_back(treePath(tree, dest));
+    }
+  }
+  return plan;
+}
+
 void application(const vector<BuildingInfo>& buildings,
                  const graph<long long, double>& G) {
-  string person1Building, person2Building;
+  application(buildings, frozen_graph<long long, double>(G));
+}
 
+void application(const vector<BuildingInfo>& buildings,
+                 const frozen_graph<long long, double>& G) {
+  application(buildings, G, VertexCoordinates(), AppOptions());
+}
+
+void application(const vector<BuildingInfo>& buildings,
+                 const frozen_graph<long long, double>& G,
+                 const VertexCoordinates& coords, const AppOptions& options) {
+  application(buildings, G, coords, BuildingMatrix(), options);
+}
+
+void application(const vector<BuildingInfo>& buildings,
+                 const frozen_graph<long long, double>& G,
+                 const VertexCoordinates& coords, const BuildingMatrix& matrix,
+                 const AppOptions& options) {
   set<long long> buildingNodes;
   for (const auto& building : buildings) {
     buildingNodes.insert(building.id);
   }
+  // Built once here; the Dijkstra-based searches test it per edge instead
+  // of looking IDs up in `buildingNodes`
+  VertexMask buildingMask(G, buildingNodes);
 
-  cout << endl;
-  cout << "Enter person 1's building (partial name or abbreviation), or #> ";
-  getline(cin, person1Building);
-
-  while (person1Building != "#") {
-    cout << "Enter person 2's building (partial name or abbreviation)> ";
-    getline(cin, person2Building);
-
-    // Look up buildings by query
-    BuildingInfo p1 = getBuildingInfo(buildings, person1Building);
-    BuildingInfo p2 = getBuildingInfo(buildings, person2Building);
-    Coordinates P1Coords, P2Coords;
-    string P1Name, P2Name;
-
-    if (p1.id == -1) {
-      cout << "Person 1's building not found" << endl;
-    } else if (p2.id == -1) {
-      cout << "Person 2's building not found" << endl;
+  SearchWorkspace workspace(G.numVertices());
+  vector<SearchWorkspace> trees;
+  Landmarks landmarks;
+  if (options.algorithm == SearchAlgorithm::ALT) {
+    landmarks = Landmarks(G, options.landmarks, defaultThreadCount());
+  }
+  size_t people = max<size_t>(options.people, 1);
+
+  while (true) {
+    // Look up each participant's building by query; "#" for person 1 quits
+    cout << endl;
+    vector<BuildingInfo> participants;
+    string query;
+    for (size_t i = 0; i < people; i++) {
+      cout << "Enter person " << i + 1
+           << "'s building (partial name or abbreviation)"
+           << (i == 0 ? ", or #> " : "> ");
+      getline(cin, query);
+      if (i == 0 && query == "#") {
+        return;
+      }
+      participants.push_back(getBuildingInfo(buildings, query));
+    }
+
+    auto missing = find_if(
+        participants.begin(), participants.end(),
+        [](const BuildingInfo& p) { return p.id == -1; });
+    if (missing != participants.end()) {
+      cout << "Person " << missing - participants.begin() + 1
+           << "'s building not found" << endl;
+      continue;
+    }
+
+    cout << endl;
+    vector<uint32_t> starts;
+    vector<Coordinates> locations;
+    for (size_t i = 0; i < people; i++) {
+      const BuildingInfo& p = participants[i];
+      cout << "Person " << i + 1 << "'s point:" << endl;
+      cout << " " << p.name << endl;
+      cout << " " << p.id << endl;
+      cout << " (" << p.location.lat << ", " << p.location.lon << ")" << endl;
+      starts.push_back(G.indexOf(p.id));
+      locations.push_back(p.location);
+    }
+
+    // Either the building nearest the midpoint, or the best one by walking
+    // distance using a full shortest-path tree from each person
+    MeetupPlan plan;
+    if (options.meetingPoint != MeetingPoint::Center) {
+      plan = planMeetup(G, buildings, starts, buildingMask,
+                        options.meetingPoint, trees, defaultThreadCount());
+    }
+    BuildingInfo dest;
+    if (plan.building != -1) {
+      dest = buildings[plan.building];
     } else {
-      cout << endl;
-      cout << "Person 1's point:" << endl;
-      cout << " " << p1.name << endl;
-      cout << " " << p1.id << endl;
-      cout << " (" << p1.location.lat << ", " << p1.location.lon << ")" << endl;
-      cout << "Person 2's point:" << endl;
-      cout << " " << p2.name << endl;
-      cout << " " << p2.id << endl;
-      cout << " (" << p2.location.lon << ", " << p2.location.lon << ")" << endl;
-
-      Coordinates centerCoords = centerBetween2Points(p1.location, p2.location);
-      BuildingInfo dest = getClosestBuilding(buildings, centerCoords);
-
-      cout << "Destination Building:" << endl;
-      cout << " " << dest.name << endl;
-      cout << " " << dest.id << endl;
-      cout << " (" << dest.location.lat << ", " << dest.location.lon << ")"
-           << endl;
+      dest = getClosestBuilding(buildings, centerOfPoints(locations));
+    }
 
-      vector<long long> P1Path = dijkstra(G, p1.id, dest.id, buildingNodes);
-      vector<long long> P2Path = dijkstra(G, p2.id, dest.id, buildingNodes);
+    cout << "Destination Building:" << endl;
+    cout << " " << dest.name << endl;
+    cout << " " << dest.id << endl;
+    cout << " (" << dest.location.lat << ", " << dest.location.lon << ")"
+         << endl;
 
-      // This should NEVER happen with how the graph is built
-      if (P1Path.empty() || P2Path.empty()) {
-        cout << endl;
-        cout << "At least one person was unable to reach the destination "
-                "building. Is an edge missing?"
-             << endl;
-        cout << endl;
+    uint32_t destIndex = G.indexOf(dest.id);
+    vector<vector<uint32_t>> paths;
+    SearchStats stats;
+    bool measured = false;  // whether `stats` covers the paths below
+    if (plan.building != -1) {
+      paths = std::move(plan.paths);
+    } else if (matrix.covers(G.numVertices(), buildings.size())) {
+      uint32_t destBuilding =
+          find(buildings.begin(), buildings.end(), dest) - buildings.begin();
+      for (uint32_t start : starts) {
+        paths.push_back(matrix.pathTo(start, destBuilding));
+      }
+    } else if (options.algorithm == SearchAlgorithm::Dijkstra) {
+      // One search back from the destination serves everyone
+      if (options.stats) {
+        paths = dijkstraOneToManyByIndex(G, destIndex, starts, buildingMask,
+                                         SearchDirection::Backward, workspace,
+                                         stats);
+        measured = true;
       } else {
-        cout << endl;
-        cout << "Person 1's distance to dest: " << pathLength(G, P1Path);
-        cout << " miles" << endl;
-        cout << "Path: ";
-        outputPath(P1Path);
-        cout << endl;
-        cout << "Person 2's distance to dest: " << pathLength(G, P2Path);
+        paths = dijkstraOneToManyByIndex(G, destIndex, starts, buildingMask,
+                                         SearchDirection::Backward, workspace);
+      }
+    } else {
+      for (uint32_t start : starts) {
+        paths.push_back(findPath(G, coords, landmarks, start, destIndex,
+                                 buildingNodes, options.algorithm));
+      }
+    }
+
+    // This should NEVER happen with how the graph is built
+    if (any_of(paths.begin(), paths.end(),
+               [](const vector<uint32_t>& path) { return path.empty(); })) {
+      cout << endl;
+      cout << "At least one person was unable to reach the destination "
+              "building. Is an edge missing?"
+           << endl;
+      cout << endl;
+    } else {
+      cout << endl;
+      for (size_t i = 0; i < people; i++) {
+        if (i > 0) {
+          cout << endl;
+        }
+        cout << "Person " << i + 1
+             << "'s distance to dest: " << pathLength(G, paths[i]);
         cout << " miles" << endl;
         cout << "Path: ";
-        outputPath(P2Path);
+        outputPath(paths[i], G.interner());
       }
     }
 
-    //
-    // another navigation?
-    //
-    cout << endl;
-    cout << "Enter person 1's building (partial name or abbreviation), or #> ";
-    getline(cin, person1Building);
+    if (options.stats) {
+      cout << endl;
+      if (measured) {
+        outputStats(stats);
+      } else {
+        cout << "Search stats: only collected when the Dijkstra search "
+                "finds the paths"
+             << endl;
+      }
+    }
   }
 }
 
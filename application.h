@@ -5,8 +5,16 @@
 #include <string>
 #include <vector>
 
+#include "astar.h"
+#include "dijkstra_kernel.h"
 #include "dist.h"
+#include "frozen_graph.h"
 #include "graph.h"
+#include "id_interner.h"
+#include "landmarks.h"
+#include "search_stats.h"
+#include "search_workspace.h"
+#include "vertex_mask.h"
 
 using namespace std;
 
@@ -30,6 +38,15 @@ struct BuildingInfo {
   }
 };
 
+/// @brief Tuning knobs for `buildGraph` / `buildGraphStreaming`.
+struct BuildOptions {
+  /// Worker threads for footway distances and building-waypoint linking.
+  /// The resulting graph is the same for any thread count. The streaming
+  /// loader computes footway distances as it parses, so only its linking
+  /// step is parallel.
+  unsigned threads = 1;
+};
+
 /// @brief Build a `graph` from the given map data in the input JSON. Building
 ///        centers that are "close to" footway nodes are manually linked.
 /// @param input stream containing JSON
@@ -38,6 +55,37 @@ struct BuildingInfo {
 void buildGraph(istream& input, graph<long long, double>& G,
                 vector<BuildingInfo>& buildings);
 
+/// @brief Same as above, but also interns every vertex id into `ids` as it is
+///        added (buildings first, then waypoints, in input order), so that
+///        `frozen_graph(G, ids)` can number vertices densely. Instantiated for
+///        both `node_hash_storage` and `flat_hash_storage` graphs.
+template <typename StorageT>
+void buildGraph(istream& input, graph<long long, double, StorageT>& G,
+                vector<BuildingInfo>& buildings, id_interner<long long>& ids);
+
+/// @brief Same as above, and also records each vertex's location in
+///        `coords`, indexed by its interned index.
+template <typename StorageT>
+void buildGraph(istream& input, graph<long long, double, StorageT>& G,
+                vector<BuildingInfo>& buildings, id_interner<long long>& ids,
+                vector<Coordinates>& coords, BuildOptions options = {});
+
+/// @brief Streaming variant of `buildGraph` built on the JSON SAX interface.
+///        Each building, waypoint and footway segment is added to `G` as soon
+///        as it is parsed instead of first materializing the whole document,
+///        so peak memory is the graph plus one record. Produces the same graph
+///        as `buildGraph`; vertices are interned in file order.
+/// @return true if the input was valid JSON; false on a parse error, in
+///         which case `G` holds whatever was parsed before the error
+bool buildGraphStreaming(istream& input, graph<long long, double>& G,
+                         vector<BuildingInfo>& buildings);
+template <typename StorageT>
+bool buildGraphStreaming(istream& input, graph<long long, double, StorageT>& G,
+                         vector<BuildingInfo>& buildings,
+                         id_interner<long long>& ids,
+                         vector<Coordinates>& coords,
+                         BuildOptions options = {});
+
 /// @brief Queries the `buildings` info to find a building that matches the
 ///        query. Either the query is exactly the abbreviation, or the query
 ///        is a substring of the building's name.
@@ -64,6 +112,261 @@ BuildingInfo getClosestBuilding(vector<BuildingInfo>& buildings, Coordinates c);
 vector<long long> dijkstra(const graph<long long, double>& G, long long start,
                            long long target, const set<long long>& ignoreNodes);
 
+/// @brief Same as above, adding the search's counters and time to `stats`.
+///        The overloads without `stats` pay nothing for the instrumentation.
+vector<long long> dijkstra(const graph<long long, double>& G, long long start,
+                           long long target, const set<long long>& ignoreNodes,
+                           SearchStats& stats);
+
+/// @brief Same as above, but runs on a read-only CSR snapshot of the graph.
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const set<long long>& ignoreNodes);
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const set<long long>& ignoreNodes,
+                           SearchStats& stats);
+
+/// @brief Same as above, keeping search state in `workspace` so the query
+///        only pays for the vertices it reaches. Without one, a per-thread
+///        workspace is used.
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const set<long long>& ignoreNodes,
+                           SearchWorkspace& workspace);
+
+/// @brief Same as above, skipping the vertices set in `excluded` (other than
+///        `start` and `target`). Build the mask once with the graph and
+///        reuse it: each check is a bit test instead of a set lookup.
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const VertexMask& excluded);
+vector<long long> dijkstra(const frozen_graph<long long, double>& G,
+                           long long start, long long target,
+                           const VertexMask& excluded,
+                           SearchWorkspace& workspace);
+
+/// @brief Dijkstra on dense vertex indices of `G`.
+/// @return dense indices on the shortest path from `start` to `target`, or
+///         empty if unreachable or out of range
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t start, uint32_t target,
+                                 const set<long long>& ignoreNodes);
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t start, uint32_t target,
+                                 const set<long long>& ignoreNodes,
+                                 SearchWorkspace& workspace);
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t start, uint32_t target,
+                                 const set<long long>& ignoreNodes,
+                                 SearchWorkspace& workspace,
+                                 SearchStats& stats);
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t start, uint32_t target,
+                                 const VertexMask& excluded);
+vector<uint32_t> dijkstraByIndex(const frozen_graph<long long, double>& G,
+                                 uint32_t start, uint32_t target,
+                                 const VertexMask& excluded,
+                                 SearchWorkspace& workspace);
+
+/// @brief Length of the path `dijkstra` would return, without building it:
+///        the search keeps no predecessors and stops at `target`.
+/// @param G graph
+/// @param start starting node ID
+/// @param target ending node ID
+/// @param ignoreNodes node IDs to skip, other than `start` and `target`
+/// @return the walking distance, or `SearchWorkspace::INF` if `target` is
+///         unreachable or either node is not in `G`
+double shortestDistance(const frozen_graph<long long, double>& G,
+                        long long start, long long target,
+                        const set<long long>& ignoreNodes);
+double shortestDistance(const frozen_graph<long long, double>& G,
+                        long long start, long long target,
+                        const VertexMask& excluded);
+
+/// @brief Same as above on dense vertex indices.
+double shortestDistanceByIndex(const frozen_graph<long long, double>& G,
+                               uint32_t start, uint32_t target,
+                               const set<long long>& ignoreNodes,
+                               SearchWorkspace& workspace);
+double shortestDistanceByIndex(const frozen_graph<long long, double>& G,
+                               uint32_t start, uint32_t target,
+                               const VertexMask& excluded,
+                               SearchWorkspace& workspace);
+
+/// @brief One Dijkstra search from `source` that stops once every target is
+///        settled. `Forward` finds paths from `source` to each target;
+///        `Backward` follows in-edges and finds paths from each target to
+///        `source`. Either way a path through `ignoreNodes` is never used,
+///        though `source` and the targets themselves may be in it.
+/// @param G graph
+/// @param source dense index the search is rooted at
+/// @param targets dense indices to find paths for
+/// @param ignoreNodes node IDs to skip, other than as path endpoints
+/// @param direction which way to follow edges
+/// @param workspace reusable search state
+/// @return one path per target in graph-edge order (source first for
+///         `Forward`, target first for `Backward`), empty if unreachable
+vector<vector<uint32_t>> dijkstraOneToManyByIndex(
+    const frozen_graph<long long, double>& G, uint32_t source,
+    const vector<uint32_t>& targets, const set<long long>& ignoreNodes,
+    SearchDirection direction, SearchWorkspace& workspace);
+
+/// @brief Same as above, skipping the vertices set in `excluded`, and
+///        optionally adding the search's counters and time to `stats`.
+vector<vector<uint32_t>> dijkstraOneToManyByIndex(
+    const frozen_graph<long long, double>& G, uint32_t source,
+    const vector<uint32_t>& targets, const VertexMask& excluded,
+    SearchDirection direction, SearchWorkspace& workspace);
+vector<vector<uint32_t>> dijkstraOneToManyByIndex(
+    const frozen_graph<long long, double>& G, uint32_t source,
+    const vector<uint32_t>& targets, const VertexMask& excluded,
+    SearchDirection direction, SearchWorkspace& workspace,
+    SearchStats& stats);
+
+/// @brief Same as above on node IDs, using a per-thread workspace.
+vector<vector<long long>> dijkstraOneToMany(
+    const frozen_graph<long long, double>& G, long long source,
+    const vector<long long>& targets, const set<long long>& ignoreNodes,
+    SearchDirection direction);
+
+/// @brief Full Dijkstra tree from `source`, left in `workspace`: afterwards
+///        `workspace.distance(v)` is the shortest distance to `v` and
+///        `treePath` recovers the path. Vertices in `ignoreNodes` get a
+///        distance but are never passed through, so each of them is reached
+///        exactly as `dijkstra` with it as the target would reach it.
+/// @param G graph
+/// @param source dense index of the tree's root
+/// @param ignoreNodes node IDs that may only end a path
+/// @param workspace search state, holding the tree on return
+void shortestPathTree(const frozen_graph<long long, double>& G,
+                      uint32_t source, const set<long long>& ignoreNodes,
+                      SearchWorkspace& workspace);
+void shortestPathTree(const frozen_graph<long long, double>& G,
+                      uint32_t source, const VertexMask& excluded,
+                      SearchWorkspace& workspace);
+
+/// @brief Path from the root of a `shortestPathTree` to `target`.
+/// @return dense indices, or empty if `target` was not reached
+vector<uint32_t> treePath(const SearchWorkspace& tree, uint32_t target);
+
+/// @brief Total weight of the edges along `path`.
+/// @return the path length, or -1 if some consecutive pair is not an edge
+double pathLength(const graph<long long, double>& G,
+                  const vector<long long>& path);
+double pathLength(const frozen_graph<long long, double>& G,
+                  const vector<long long>& path);
+double pathLength(const frozen_graph<long long, double>& G,
+                  const vector<uint32_t>& path);
+
+/// @brief Print `path` as `id->id->...`, translating dense indices back to
+///        vertex ids through `ids`.
+void outputPath(const vector<long long>& path);
+void outputPath(const vector<uint32_t>& path, const id_interner<long long>& ids);
+
+/// @brief Print `stats` on one line.
+void outputStats(const SearchStats& stats);
+
+/// Point-to-point search algorithms that return identical shortest paths
+enum class SearchAlgorithm { Dijkstra, AStar, Bidirectional, ALT };
+
+/// @brief Parse "dijkstra", "astar", "bidirectional" or "alt".
+/// @return true if `name` was recognized, and `algorithm` is set
+bool parseSearchAlgorithm(const string& name, SearchAlgorithm& algorithm);
+
+/// @brief Shortest path by dense index with the chosen algorithm, so callers
+///        can pick one per query. A* needs `coords` and ALT needs
+///        `landmarks` computed for `G`; without them both fall back to
+///        Dijkstra.
+vector<uint32_t> findPath(const frozen_graph<long long, double>& G,
+                          const VertexCoordinates& coords,
+                          const Landmarks& landmarks, uint32_t start,
+                          uint32_t target, const set<long long>& ignoreNodes,
+                          SearchAlgorithm algorithm);
+
+/// How the meetup flow picks the destination building
+enum class MeetingPoint {
+  Center,  // building closest to the geographic midpoint
+  MinMax,  // shortest longest walk over the network
+  MinSum,  // shortest total walking over the network
+};
+
+/// @brief Parse "center", "minmax" or "minsum".
+/// @return true if `name` was recognized, and `meetingPoint` is set
+bool parseMeetingPoint(const string& name, MeetingPoint& meetingPoint);
+
+/// @brief Pick the building that minimizes `objective` over walking
+///        distances, given one `shortestPathTree` per person, in a single
+///        pass over `buildings`. Ties go to the better secondary measure
+///        (sum for MinMax, max for MinSum), then to catalog order.
+/// @param G graph the trees were grown on
+/// @param buildings candidate buildings
+/// @param trees one tree per person
+/// @param objective MinMax or MinSum
+/// @return position of the chosen building in `buildings`, or -1 if no
+///         building is reachable by everyone
+int chooseMeetingBuilding(const frozen_graph<long long, double>& G,
+                          const vector<BuildingInfo>& buildings,
+                          const vector<SearchWorkspace>& trees,
+                          MeetingPoint objective);
+
+/// Where a group should meet and how each participant gets there
+struct MeetupPlan {
+  int building = -1;               // position in the catalog, or -1
+  vector<vector<uint32_t>> paths;  // per participant, dense indices
+};
+
+/// @brief Plan a meetup for any number of participants: one
+///        `shortestPathTree` per participant, grown in parallel, then
+///        `chooseMeetingBuilding` and each participant's path out of their
+///        tree. Costs one search per participant regardless of the number
+///        of buildings.
+/// @param G graph
+/// @param buildings candidate buildings
+/// @param participants dense index of each participant's starting vertex
+/// @param ignoreNodes node IDs that may only start or end a path
+/// @param objective MinMax or MinSum
+/// @param trees reusable search state; resized to one per participant
+/// @param threads worker threads for the searches
+/// @return the chosen building and paths, or `building == -1` and no paths
+///         if no building is reachable by everyone
+MeetupPlan planMeetup(const frozen_graph<long long, double>& G,
+                      const vector<BuildingInfo>& buildings,
+                      const vector<uint32_t>& participants,
+                      const set<long long>& ignoreNodes,
+                      MeetingPoint objective, vector<SearchWorkspace>& trees,
+                      unsigned threads);
+
+/// @brief Same as above, skipping the vertices set in `excluded`.
+MeetupPlan planMeetup(const frozen_graph<long long, double>& G,
+                      const vector<BuildingInfo>& buildings,
+                      const vector<uint32_t>& participants,
+                      const VertexMask& excluded, MeetingPoint objective,
+                      vector<SearchWorkspace>& trees, unsigned threads);
+
+/// Settings for the interactive command loop
+struct AppOptions {
+  SearchAlgorithm algorithm = SearchAlgorithm::Dijkstra;
+  size_t landmarks = 16;  // landmarks to compute when using ALT
+  MeetingPoint meetingPoint = MeetingPoint::Center;
+  size_t people = 2;  // participants per meetup
+  bool stats = false;  // print search statistics after each meetup
+};
+
 /// Command loop to request input
 void application(const vector<BuildingInfo>& Buildings,
                  const graph<long long, double>& G);
+void application(const vector<BuildingInfo>& Buildings,
+                 const frozen_graph<long long, double>& G);
+void application(const vector<BuildingInfo>& Buildings,
+                 const frozen_graph<long long, double>& G,
+                 const VertexCoordinates& coords, const AppOptions& options);
+
+class BuildingMatrix;
+
+/// @brief Same as above, answering each person's path to the destination
+///        from `matrix` by table lookup when it covers `G` and `Buildings`.
+void application(const vector<BuildingInfo>& Buildings,
+                 const frozen_graph<long long, double>& G,
+                 const VertexCoordinates& coords, const BuildingMatrix& matrix,
+                 const AppOptions& options);
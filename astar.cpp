@@ -0,0 +1,44 @@
+#include "astar.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+VertexCoordinates::VertexCoordinates(const frozen_graph<long long, double>& G,
+                                     vector<Coordinates> coords)
+    : coords(std::move(coords)), scale(1) {
+  this->coords.resize(G.numVertices());
+  for (uint32_t u = 0; u < G.numVertices(); u++) {
+    for (uint32_t e = G.edgeBegin(u); e < G.edgeEnd(u); e++) {
+      double straight = haversineDistance(this->coords[u],
+                                          this->coords[G.edgeTarget(e)]);
+      if (straight > 0) {
+        scale = min(scale, max(0.0, G.edgeWeight(e)) / straight);
+      }
+    }
+  }
+  // Leave room for rounding in the heuristic itself
+  scale *= 1 - 1e-9;
+}
+
+vector<uint32_t> astarByIndex(const frozen_graph<long long, double>& G,
+                              const VertexCoordinates& coords, uint32_t s,
+                              uint32_t t, const set<long long>& ignoreNodes) {
+  return goalDirectedSearch(
+      G, s, t, ignoreNodes,
+      [&coords](uint32_t u, uint32_t v) { return coords.lowerBound(u, v); });
+}
+
+vector<long long> astar(const frozen_graph<long long, double>& G,
+                        const VertexCoordinates& coords, long long start,
+                        long long target, const set<long long>& ignoreNodes) {
+  vector<uint32_t> dense = astarByIndex(G, coords, G.indexOf(start),
+                                        G.indexOf(target), ignoreNodes);
+  vector<long long> path;
+  path.reserve(dense.size());
+  for (uint32_t u : dense) {
+    path.push_back(G.vertexAt(u));
+  }
+  return path;
+}
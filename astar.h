@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "dist.h"
+#include "frozen_graph.h"
+
+using namespace std;
+
+/// @brief Per-vertex coordinates kept alongside a frozen graph, plus the
+///        factor that turns great-circle distance into a lower bound on path
+///        length. Edge weights come from `distBetween2Points`, which can come
+///        out slightly shorter than the true great-circle distance for very
+///        short edges. `scale` is the largest factor in (0, 1] with
+///        `scale * haversine(u, v) <= weight(u, v)` for every edge, which
+///        makes `lowerBound` an admissible and consistent A* heuristic.
+struct VertexCoordinates {
+  vector<Coordinates> coords;  // indexed by dense vertex index
+  double scale;
+
+  VertexCoordinates() : scale(0) {
+  }
+
+  /// @brief Attach `coords` (indexed like `G`) and compute `scale` in O(|E|).
+  VertexCoordinates(const frozen_graph<long long, double>& G,
+                    vector<Coordinates> coords);
+
+  /// @brief Lower bound on the length of any path from `u` to `v`.
+  double lowerBound(uint32_t u, uint32_t v) const {
+    return scale * haversineDistance(coords[u], coords[v]);
+  }
+};
+
+/// @brief A* search from `start` to `target` guided by straight-line distance
+///        to the target. Same contract as `dijkstra`, including how
+///        `ignoreNodes` is treated, and returns the same shortest path while
+///        settling far fewer vertices on point-to-point queries.
+/// @param G graph
+/// @param coords coordinates of `G`'s vertices
+/// @param start starting node ID
+/// @param target ending node ID
+/// @param ignoreNodes node IDs to skip, other than `start` and `target`
+/// @return node IDs on shortest path from `start` to `target`, or empty
+vector<long long> astar(const frozen_graph<long long, double>& G,
+                        const VertexCoordinates& coords, long long start,
+                        long long target, const set<long long>& ignoreNodes);
+
+/// @brief Same as above on dense vertex indices.
+vector<uint32_t> astarByIndex(const frozen_graph<long long, double>& G,
+                              const VertexCoordinates& coords, uint32_t start,
+                              uint32_t target,
+                              const set<long long>& ignoreNodes);
+
+/// @brief A* on dense vertex indices with any admissible heuristic, shared by
+///        the straight-line and landmark variants. Vertices are reopened if a
+///        shorter path to them turns up, so the heuristic need not be
+///        consistent.
+/// @param lowerBound callable `(uint32_t u, uint32_t target) -> double` that
+///        never overestimates the distance from `u` to `target`
+template <typename LowerBound>
+vector<uint32_t> goalDirectedSearch(const frozen_graph<long long, double>& G,
+                                    uint32_t s, uint32_t t,
+                                    const set<long long>& ignoreNodes,
+                                    LowerBound&& lowerBound) {
+  using FG = frozen_graph<long long, double>;
+  const double INF = numeric_limits<double>::max();
+  size_t n = G.numVertices();
+  if (s >= n || t >= n) {
+    return {};
+  }
+
+  vector<double> distances(n, INF);
+  vector<uint32_t> predecessors(n, FG::NONE);
+  vector<bool> ignored(n, false);
+  for (long long id : ignoreNodes) {
+    uint32_t i = G.indexOf(id);
+    if (i != FG::NONE) {
+      ignored[i] = true;
+    }
+  }
+  ignored[s] = false;
+  ignored[t] = false;
+
+  // (estimated total, distance so far, vertex)
+  using Entry = tuple<double, double, uint32_t>;
+  priority_queue<Entry, vector<Entry>, greater<>> pq;
+  distances[s] = 0;
+  pq.emplace(lowerBound(s, t), 0, s);
+
+  while (!pq.empty()) {
+    auto [estimate, currentDist, u] = pq.top();
+    pq.pop();
+
+    if (u == t) {
+      break;
+    }
+    if (ignored[u] || currentDist > distances[u]) {
+      continue;
+    }
+
+    for (uint32_t e = G.edgeBegin(u); e < G.edgeEnd(u); e++) {
+      uint32_t v = G.edgeTarget(e);
+      if (ignored[v]) {
+        continue;
+      }
+      double newDist = currentDist + G.edgeWeight(e);
+      if (newDist < distances[v]) {
+        distances[v] = newDist;
+        predecessors[v] = u;
+        pq.emplace(newDist + lowerBound(v, t), newDist, v);
+      }
+    }
+  }
+
+  if (distances[t] == INF) {
+    return {};
+  }
+
+  vector<uint32_t> path;
+  for (uint32_t at = t; at != s; at = predecessors[at]) {
+    path.push_back(at);
+  }
+  path.push_back(s);
+  reverse(path.begin(), path.end());
+  return path;
+}
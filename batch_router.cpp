@@ -0,0 +1,63 @@
+#include "batch_router.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "application.h"
+
+using namespace std;
+
+namespace {
+
+// Queries per grab from the shared counter: big enough to keep contention
+// on it negligible, small enough to balance uneven query costs
+const size_t BATCH_CHUNK = 16;
+
+}  // namespace
+
+BatchRouter::BatchRouter(const frozen_graph<long long, double>& G,
+                         unsigned threads)
+    : G(G), pool(threads), workspaces(pool.size()) {
+}
+
+vector<vector<uint32_t>> BatchRouter::routeByIndex(
+    const vector<pair<uint32_t, uint32_t>>& queries,
+    const set<long long>& ignoreNodes) {
+  vector<vector<uint32_t>> paths(queries.size());
+  atomic<size_t> next(0);
+  pool.run([&](unsigned worker) {
+    SearchWorkspace& workspace = workspaces[worker];
+    while (true) {
+      size_t begin = next.fetch_add(BATCH_CHUNK);
+      if (begin >= queries.size()) {
+        return;
+      }
+      size_t end = min(queries.size(), begin + BATCH_CHUNK);
+      for (size_t i = begin; i < end; i++) {
+        paths[i] = dijkstraByIndex(G, queries[i].first, queries[i].second,
+                                   ignoreNodes, workspace);
+      }
+    }
+  });
+  return paths;
+}
+
+vector<vector<long long>> BatchRouter::route(
+    const vector<pair<long long, long long>>& queries,
+    const set<long long>& ignoreNodes) {
+  vector<pair<uint32_t, uint32_t>> dense;
+  dense.reserve(queries.size());
+  for (const auto& [start, target] : queries) {
+    dense.emplace_back(G.indexOf(start), G.indexOf(target));
+  }
+
+  vector<vector<uint32_t>> densePaths = routeByIndex(dense, ignoreNodes);
+  vector<vector<long long>> paths(densePaths.size());
+  for (size_t i = 0; i < densePaths.size(); i++) {
+    paths[i].reserve(densePaths[i].size());
+    for (uint32_t u : densePaths[i]) {
+      paths[i].push_back(G.vertexAt(u));
+    }
+  }
+  return paths;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "frozen_graph.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+/// @brief Answers many point-to-point queries at once on a fixed-size
+///        thread pool. Workers share the read-only graph and each keep
+///        their own `SearchWorkspace`, so queries need no locking and only
+///        touch the vertices they explore. Queries are handed out in small
+///        chunks, which keeps the workers evenly loaded when query costs vary.
+///
+///        `G` must outlive the router and must not change while it is used.
+///        One batch runs at a time per router.
+class BatchRouter {
+ public:
+  /// @brief Start `threads` workers for queries on `G`.
+  BatchRouter(const frozen_graph<long long, double>& G, unsigned threads);
+
+  /// @brief Shortest path for every `(start, target)` node ID pair, with the
+  ///        same contract as `dijkstra`.
+  /// @return one path per query, in query order; empty if unreachable
+  vector<vector<long long>> route(
+      const vector<pair<long long, long long>>& queries,
+      const set<long long>& ignoreNodes);
+
+  /// @brief Same as above on dense vertex indices.
+  vector<vector<uint32_t>> routeByIndex(
+      const vector<pair<uint32_t, uint32_t>>& queries,
+      const set<long long>& ignoreNodes);
+
+  /// @brief Number of worker threads.
+  unsigned threads() const {
+    return pool.size();
+  }
+
+ private:
+  const frozen_graph<long long, double>& G;
+  ThreadPool pool;
+  vector<SearchWorkspace> workspaces;  // one per worker
+};
@@ -0,0 +1,118 @@
+#include "bidirectional_dijkstra.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+vector<uint32_t> bidirectionalDijkstraByIndex(
+    const frozen_graph<long long, double>& G, uint32_t s, uint32_t t,
+    const set<long long>& ignoreNodes) {
+  using FG = frozen_graph<long long, double>;
+  using Entry = pair<double, uint32_t>;
+  const double INF = numeric_limits<double>::max();
+  size_t n = G.numVertices();
+  if (s >= n || t >= n) {
+    return {};
+  }
+  if (s == t) {
+    return {s};
+  }
+
+  vector<bool> ignored(n, false);
+  for (long long id : ignoreNodes) {
+    uint32_t i = G.indexOf(id);
+    if (i != FG::NONE) {
+      ignored[i] = true;
+    }
+  }
+  ignored[s] = false;
+  ignored[t] = false;
+
+  // Index 0 is the forward search from s, index 1 the backward search from t
+  vector<double> distances[2] = {vector<double>(n, INF),
+                                 vector<double>(n, INF)};
+  vector<uint32_t> parents[2] = {vector<uint32_t>(n, FG::NONE),
+                                 vector<uint32_t>(n, FG::NONE)};
+  priority_queue<Entry, vector<Entry>, greater<>> pq[2];
+  distances[0][s] = 0;
+  distances[1][t] = 0;
+  pq[0].emplace(0, s);
+  pq[1].emplace(0, t);
+
+  double best = INF;
+  uint32_t meet = FG::NONE;
+
+  auto relax = [&](int side, uint32_t u, uint32_t v, double w) {
+    if (ignored[v]) {
+      return;
+    }
+    double newDist = distances[side][u] + w;
+    if (newDist < distances[side][v]) {
+      distances[side][v] = newDist;
+      parents[side][v] = u;
+      pq[side].emplace(newDist, v);
+      if (distances[1 - side][v] != INF &&
+          newDist + distances[1 - side][v] < best) {
+        best = newDist + distances[1 - side][v];
+        meet = v;
+      }
+    }
+  };
+
+  while (!pq[0].empty() && !pq[1].empty()) {
+    // Nothing left in either frontier can improve on `best`
+    if (pq[0].top().first + pq[1].top().first >= best) {
+      break;
+    }
+
+    int side = pq[0].top().first <= pq[1].top().first ? 0 : 1;
+    auto [currentDist, u] = pq[side].top();
+    pq[side].pop();
+    if (currentDist > distances[side][u] || ignored[u]) {
+      continue;
+    }
+
+    if (side == 0) {
+      for (uint32_t e = G.edgeBegin(u); e < G.edgeEnd(u); e++) {
+        relax(0, u, G.edgeTarget(e), G.edgeWeight(e));
+      }
+    } else {
+      for (uint32_t e = G.inEdgeBegin(u); e < G.inEdgeEnd(u); e++) {
+        relax(1, u, G.inEdgeSource(e), G.inEdgeWeight(e));
+      }
+    }
+  }
+
+  if (meet == FG::NONE) {
+    return {};
+  }
+
+  vector<uint32_t> path;
+  for (uint32_t at = meet; at != s; at = parents[0][at]) {
+    path.push_back(at);
+  }
+  path.push_back(s);
+  reverse(path.begin(), path.end());
+  for (uint32_t at = meet; at != t;) {
+    at = parents[1][at];
+    path.push_back(at);
+  }
+  return path;
+}
+
+vector<long long> bidirectionalDijkstra(
+    const frozen_graph<long long, double>& G, long long start, long long target,
+    const set<long long>& ignoreNodes) {
+  vector<uint32_t> dense = bidirectionalDijkstraByIndex(
+      G, G.indexOf(start), G.indexOf(target), ignoreNodes);
+  vector<long long> path;
+  path.reserve(dense.size());
+  for (uint32_t u : dense) {
+    path.push_back(G.vertexAt(u));
+  }
+  return path;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "frozen_graph.h"
+
+using namespace std;
+
+/// @brief Bidirectional Dijkstra: grows one search forward from `start` and
+///        one backward from `target` over in-edges, always advancing the side
+///        with the smaller frontier key, and stops once the two frontier keys
+///        together reach the best start-to-target distance seen so far. Same
+///        contract as `dijkstra`, including how `ignoreNodes` is treated.
+/// @param G graph
+/// @param start starting node ID
+/// @param target ending node ID
+/// @param ignoreNodes node IDs to skip, other than `start` and `target`
+/// @return node IDs on shortest path from `start` to `target`, or empty
+vector<long long> bidirectionalDijkstra(
+    const frozen_graph<long long, double>& G, long long start, long long target,
+    const set<long long>& ignoreNodes);
+
+/// @brief Same as above on dense vertex indices.
+vector<uint32_t> bidirectionalDijkstraByIndex(
+    const frozen_graph<long long, double>& G, uint32_t start, uint32_t target,
+    const set<long long>& ignoreNodes);
@@ -0,0 +1,95 @@
+#include "building_matrix.h"
+
+#include <utility>
+#include <vector>
+
+#include "dijkstra_kernel.h"
+#include "parallel.h"
+#include "search_workspace.h"
+
+using namespace std;
+
+BuildingMatrix::BuildingMatrix(const frozen_graph<long long, double>& G,
+                               const vector<BuildingInfo>& buildings,
+                               unsigned threads)
+    : vertexCount(G.numVertices()) {
+  size_t n = G.numVertices();
+  size_t b = buildings.size();
+  buildingVertices.reserve(b);
+  for (const BuildingInfo& building : buildings) {
+    buildingVertices.push_back(G.indexOf(building.id));
+  }
+  distances.assign(b * b, INF);
+  nextHops.assign(b * n, NONE);
+
+  // Each search only writes its own target's next-hop row and distance
+  // column, so the chunks never touch the same entries
+  parallelFor(b, threads, [&](size_t begin, size_t end) {
+    SearchWorkspace workspace(n);
+    for (size_t target = begin; target < end; target++) {
+      uint32_t root = buildingVertices[target];
+      if (root == NONE) {
+        continue;
+      }
+
+      workspace.reset(n);
+      for (uint32_t v : buildingVertices) {
+        if (v != NONE && v != root) {
+          workspace.setIgnored(v, true);
+        }
+      }
+
+      // Backward over in-edges: a vertex's predecessor in this tree is its
+      // next hop toward `root`. Other buildings get labels but are never
+      // expanded, so they can start a path but not carry one.
+      ExploreAll termination;
+      dijkstraSearch<SearchDirection::Backward>(
+          G, root, workspace, workspace.heap(), ExcludeIgnored{workspace},
+          termination, RecordPredecessors());
+      uint32_t* row = &nextHops[target * n];
+      for (uint32_t u = 0; u < n; u++) {
+        if (workspace.settled(u)) {
+          row[u] = workspace.predecessor(u);
+        }
+      }
+
+      for (size_t from = 0; from < b; from++) {
+        uint32_t v = buildingVertices[from];
+        if (v != NONE) {
+          distances[from * b + target] = workspace.distance(v);
+        }
+      }
+    }
+  });
+}
+
+BuildingMatrix::BuildingMatrix(size_t numVertices,
+                               vector<uint32_t> buildingVertices,
+                               vector<double> distances,
+                               vector<uint32_t> nextHops)
+    : vertexCount(numVertices),
+      buildingVertices(std::move(buildingVertices)),
+      distances(std::move(distances)),
+      nextHops(std::move(nextHops)) {
+}
+
+vector<uint32_t> BuildingMatrix::pathTo(uint32_t from, uint32_t to) const {
+  if (to >= buildingVertices.size() || from >= vertexCount) {
+    return {};
+  }
+  uint32_t root = buildingVertices[to];
+  if (root == NONE) {
+    return {};
+  }
+
+  const uint32_t* row = &nextHops[to * vertexCount];
+  vector<uint32_t> path = {from};
+  for (uint32_t at = from; at != root; at = row[at]) {
+    // Unreached, or a corrupt row that would otherwise loop forever
+    if (row[at] == NONE || path.size() > vertexCount) {
+      return {};
+    }
+    path.push_back(row[at]);
+  }
+  return path;
+}
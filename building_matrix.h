@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "application.h"
+#include "frozen_graph.h"
+
+using namespace std;
+
+/// @brief All-pairs building table: the walking distance between every pair
+///        of buildings, plus, for each building, the next hop toward it from
+///        every vertex. Any path ending at a building is then unpacked by
+///        following next hops, with no search at all.
+///
+///        Paths follow the same rule as the meetup flow: buildings other
+///        than the two endpoints are never passed through. Each row comes
+///        from one backward search rooted at its building, so paths match
+///        `dijkstraOneToManyByIndex` with `SearchDirection::Backward`.
+class BuildingMatrix {
+ public:
+  static constexpr double INF = numeric_limits<double>::max();
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  /// Empty table; `covers` is false for every graph
+  BuildingMatrix() = default;
+
+  /// @brief Run one search per building, spread over `threads` threads.
+  ///        Needs O(B * V) memory for the next-hop rows.
+  /// @param G graph
+  /// @param buildings building catalog; table indices follow its order
+  /// @param threads worker threads
+  BuildingMatrix(const frozen_graph<long long, double>& G,
+                 const vector<BuildingInfo>& buildings, unsigned threads = 1);
+
+  /// @brief Adopt precomputed arrays, e.g. from a cache file. Sizes must
+  ///        match: `distances` is B * B and `nextHops` is B * `numVertices`.
+  BuildingMatrix(size_t numVertices, vector<uint32_t> buildingVertices,
+                 vector<double> distances, vector<uint32_t> nextHops);
+
+  /// @brief Whether the table was built for a graph with `numVertices`
+  ///        vertices and a catalog of `numBuildings` buildings.
+  bool covers(size_t numVertices, size_t numBuildings) const {
+    return numBuildings > 0 && buildingVertices.size() == numBuildings &&
+           vertexCount == numVertices;
+  }
+
+  size_t numBuildings() const {
+    return buildingVertices.size();
+  }
+
+  /// @brief Walking distance from building `from` to building `to`, by
+  ///        catalog position, or `INF` if there is no path.
+  double distance(uint32_t from, uint32_t to) const {
+    return distances[from * buildingVertices.size() + to];
+  }
+
+  /// @brief Path from dense vertex `from` to building `to`, or empty if
+  ///        there is none. O(path length).
+  vector<uint32_t> pathTo(uint32_t from, uint32_t to) const;
+
+  /// Raw arrays, for writing the table to disk
+  const vector<uint32_t>& vertices() const {
+    return buildingVertices;
+  }
+  const vector<double>& distanceTable() const {
+    return distances;
+  }
+  const vector<uint32_t>& nextHopTable() const {
+    return nextHops;
+  }
+
+ private:
+  size_t vertexCount = 0;
+  vector<uint32_t> buildingVertices;  // dense index, or NONE if not in G
+  vector<double> distances;           // [from * B + to]
+  vector<uint32_t> nextHops;          // [to * V + vertex]
+};
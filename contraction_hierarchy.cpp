@@ -0,0 +1,368 @@
+#include "contraction_hierarchy.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const double INF = numeric_limits<double>::max();
+const uint32_t NONE = UINT32_MAX;
+
+// Witness searches give up after settling this many vertices, in which case
+// the shortcut is kept. Extra shortcuts cost space, never correctness.
+const size_t WITNESS_SETTLE_LIMIT = 500;
+
+struct WorkArc {
+  uint32_t other;
+  double weight;
+  uint32_t middle;
+};
+
+/// The not-yet-contracted part of the graph during preprocessing. Each vertex
+/// keeps its arcs after it is contracted; those become its search-graph arcs,
+/// since every neighbor left at that point is ranked above it.
+class Contractor {
+ public:
+  vector<vector<WorkArc>> out;
+  vector<vector<WorkArc>> in;
+
+  explicit Contractor(const frozen_graph<long long, double>& G)
+      : out(G.numVertices()),
+        in(G.numVertices()),
+        contractedNeighbors(G.numVertices(), 0),
+        dist(G.numVertices(), INF) {
+    for (uint32_t u = 0; u < G.numVertices(); u++) {
+      for (uint32_t e = G.edgeBegin(u); e < G.edgeEnd(u); e++) {
+        if (G.edgeTarget(e) != u) {
+          addArc(u, G.edgeTarget(e), G.edgeWeight(e), NONE);
+        }
+      }
+    }
+  }
+
+  /// Add `u -> w`, or shorten it if it is already there.
+  void addArc(uint32_t u, uint32_t w, double weight, uint32_t middle) {
+    if (setArc(out[u], w, weight, middle)) {
+      setArc(in[w], u, weight, middle);
+    }
+  }
+
+  /// Number of shortcuts contracting `v` needs; adds them if `apply`.
+  size_t shortcutsFor(uint32_t v, bool apply) {
+    vector<tuple<uint32_t, uint32_t, double>> pending;
+    for (const WorkArc& first : in[v]) {
+      uint32_t u = first.other;
+      double limit = -1;
+      for (const WorkArc& second : out[v]) {
+        if (second.other != u) {
+          limit = max(limit, first.weight + second.weight);
+        }
+      }
+      if (limit < 0) {
+        continue;
+      }
+
+      witnessSearch(u, v, limit);
+      for (const WorkArc& second : out[v]) {
+        double via = first.weight + second.weight;
+        if (second.other != u && dist[second.other] > via) {
+          pending.emplace_back(u, second.other, via);
+        }
+      }
+      for (uint32_t x : touched) {
+        dist[x] = INF;
+      }
+      touched.clear();
+    }
+
+    if (apply) {
+      for (const auto& [u, w, weight] : pending) {
+        addArc(u, w, weight, v);
+      }
+    }
+    return pending.size();
+  }
+
+  /// Edge difference plus a term that spreads contraction evenly.
+  long long priority(uint32_t v) {
+    return (long long)shortcutsFor(v, false) -
+           (long long)(in[v].size() + out[v].size()) + contractedNeighbors[v];
+  }
+
+  /// Detach `v` from the remaining graph; its own arc lists are kept.
+  void remove(uint32_t v) {
+    for (const WorkArc& a : out[v]) {
+      eraseArc(in[a.other], v);
+      contractedNeighbors[a.other]++;
+    }
+    for (const WorkArc& a : in[v]) {
+      eraseArc(out[a.other], v);
+      contractedNeighbors[a.other]++;
+    }
+  }
+
+ private:
+  vector<uint32_t> contractedNeighbors;
+  vector<double> dist;
+  vector<uint32_t> touched;
+
+  static bool setArc(vector<WorkArc>& arcs, uint32_t other, double weight,
+                     uint32_t middle) {
+    for (WorkArc& a : arcs) {
+      if (a.other == other) {
+        if (weight >= a.weight) {
+          return false;
+        }
+        a.weight = weight;
+        a.middle = middle;
+        return true;
+      }
+    }
+    arcs.push_back({other, weight, middle});
+    return true;
+  }
+
+  static void eraseArc(vector<WorkArc>& arcs, uint32_t other) {
+    for (size_t i = 0; i < arcs.size(); i++) {
+      if (arcs[i].other == other) {
+        arcs[i] = arcs.back();
+        arcs.pop_back();
+        return;
+      }
+    }
+  }
+
+  /// Distances from `source` in the remaining graph without `avoid`, exact up
+  /// to `limit`. Leaves results in `dist`, with `touched` listing the entries.
+  void witnessSearch(uint32_t source, uint32_t avoid, double limit) {
+    using Entry = pair<double, uint32_t>;
+    priority_queue<Entry, vector<Entry>, greater<>> pq;
+    dist[source] = 0;
+    touched.push_back(source);
+    pq.emplace(0, source);
+
+    size_t settled = 0;
+    while (!pq.empty()) {
+      auto [d, x] = pq.top();
+      pq.pop();
+      if (d > dist[x]) {
+        continue;
+      }
+      if (d > limit || ++settled > WITNESS_SETTLE_LIMIT) {
+        break;
+      }
+      for (const WorkArc& a : out[x]) {
+        double nd = d + a.weight;
+        if (a.other != avoid && nd < dist[a.other]) {
+          if (dist[a.other] == INF) {
+            touched.push_back(a.other);
+          }
+          dist[a.other] = nd;
+          pq.emplace(nd, a.other);
+        }
+      }
+    }
+  }
+};
+
+}  // namespace
+
+ContractionHierarchy::ContractionHierarchy(
+    const frozen_graph<long long, double>& G,
+    const set<long long>& noPassThrough)
+    : ids(G.interner()),
+      rank(G.numVertices(), NONE),
+      passThrough(G.numVertices(), true) {
+  uint32_t n = G.numVertices();
+  for (long long id : noPassThrough) {
+    uint32_t i = G.indexOf(id);
+    if (i != NONE) {
+      passThrough[i] = false;
+    }
+  }
+
+  // Excluded vertices go first and without shortcuts, so no path through
+  // them survives into the hierarchy or into later witness searches
+  Contractor c(G);
+  uint32_t next = 0;
+  for (uint32_t v = 0; v < n; v++) {
+    if (!passThrough[v]) {
+      rank[v] = next++;
+      c.remove(v);
+    }
+  }
+
+  // Lazy updates: a popped vertex whose priority has gone up since it was
+  // queued goes back in instead of being contracted
+  using Entry = pair<long long, uint32_t>;
+  priority_queue<Entry, vector<Entry>, greater<>> pq;
+  for (uint32_t v = 0; v < n; v++) {
+    if (passThrough[v]) {
+      pq.emplace(c.priority(v), v);
+    }
+  }
+  while (!pq.empty()) {
+    uint32_t v = pq.top().second;
+    pq.pop();
+    long long p = c.priority(v);
+    if (!pq.empty() && p > pq.top().first) {
+      pq.emplace(p, v);
+      continue;
+    }
+    c.shortcutsFor(v, true);
+    rank[v] = next++;
+    c.remove(v);
+  }
+
+  upOffsets.assign(n + 1, 0);
+  downOffsets.assign(n + 1, 0);
+  for (uint32_t v = 0; v < n; v++) {
+    for (const WorkArc& a : c.out[v]) {
+      if (rank[a.other] > rank[v]) {
+        upArcs.push_back({a.other, a.weight, a.middle});
+        shortcuts += a.middle != NONE;
+      }
+    }
+    for (const WorkArc& a : c.in[v]) {
+      if (rank[a.other] > rank[v]) {
+        downArcs.push_back({a.other, a.weight, a.middle});
+        shortcuts += a.middle != NONE;
+      }
+    }
+    upOffsets[v + 1] = upArcs.size();
+    downOffsets[v + 1] = downArcs.size();
+  }
+}
+
+void ContractionHierarchy::unpack(uint32_t from, const Arc& arc,
+                                  vector<uint32_t>& path) const {
+  if (arc.middle == NONE) {
+    path.push_back(arc.other);
+    return;
+  }
+
+  // The bypassed vertex is ranked below both ends, so `from -> middle` is one
+  // of its down arcs and `middle -> other` one of its up arcs
+  uint32_t m = arc.middle;
+  for (uint32_t i = downOffsets[m]; i < downOffsets[m + 1]; i++) {
+    if (downArcs[i].other == from) {
+      unpack(from, {m, downArcs[i].weight, downArcs[i].middle}, path);
+      break;
+    }
+  }
+  for (uint32_t i = upOffsets[m]; i < upOffsets[m + 1]; i++) {
+    if (upArcs[i].other == arc.other) {
+      unpack(m, upArcs[i], path);
+      break;
+    }
+  }
+}
+
+vector<uint32_t> ContractionHierarchy::queryByIndex(uint32_t s,
+                                                    uint32_t t) const {
+  size_t n = rank.size();
+  if (s >= n || t >= n) {
+    return {};
+  }
+  if (s == t) {
+    return {s};
+  }
+
+  // Side 0 searches up from `s`, side 1 searches up from `t` over reversed
+  // arcs. `via[side][v]` is the arc index that last improved `v`.
+  vector<double> dist[2] = {vector<double>(n, INF), vector<double>(n, INF)};
+  vector<uint32_t> pred[2] = {vector<uint32_t>(n, NONE),
+                              vector<uint32_t>(n, NONE)};
+  vector<uint32_t> via[2] = {vector<uint32_t>(n, NONE),
+                             vector<uint32_t>(n, NONE)};
+  const vector<uint32_t>* offsets[2] = {&upOffsets, &downOffsets};
+  const vector<Arc>* arcs[2] = {&upArcs, &downArcs};
+  const uint32_t source[2] = {s, t};
+
+  using Entry = pair<double, uint32_t>;
+  priority_queue<Entry, vector<Entry>, greater<>> pq[2];
+  dist[0][s] = 0;
+  dist[1][t] = 0;
+  pq[0].emplace(0, s);
+  pq[1].emplace(0, t);
+
+  double best = INF;
+  uint32_t meet = NONE;
+  auto tryMeet = [&](uint32_t v) {
+    if ((passThrough[v] || v == s || v == t) && dist[0][v] != INF &&
+        dist[1][v] != INF && dist[0][v] + dist[1][v] < best) {
+      best = dist[0][v] + dist[1][v];
+      meet = v;
+    }
+  };
+
+  while (true) {
+    bool forward = !pq[0].empty() && pq[0].top().first < best;
+    bool backward = !pq[1].empty() && pq[1].top().first < best;
+    if (!forward && !backward) {
+      break;
+    }
+    int side =
+        forward && (!backward || pq[0].top().first <= pq[1].top().first) ? 0
+                                                                         : 1;
+    auto [d, u] = pq[side].top();
+    pq[side].pop();
+    if (d > dist[side][u]) {
+      continue;
+    }
+    tryMeet(u);
+    if (!passThrough[u] && u != source[side]) {
+      continue;
+    }
+
+    for (uint32_t i = (*offsets[side])[u]; i < (*offsets[side])[u + 1]; i++) {
+      const Arc& a = (*arcs[side])[i];
+      double nd = d + a.weight;
+      if (nd < dist[side][a.other]) {
+        dist[side][a.other] = nd;
+        pred[side][a.other] = u;
+        via[side][a.other] = i;
+        pq[side].emplace(nd, a.other);
+        tryMeet(a.other);
+      }
+    }
+  }
+
+  if (meet == NONE) {
+    return {};
+  }
+
+  // s ... meet over up arcs, collected backwards
+  vector<uint32_t> hops;
+  for (uint32_t v = meet; v != s; v = pred[0][v]) {
+    hops.push_back(v);
+  }
+  vector<uint32_t> path = {s};
+  for (auto it = hops.rbegin(); it != hops.rend(); it++) {
+    unpack(pred[0][*it], upArcs[via[0][*it]], path);
+  }
+  // meet ... t over reversed down arcs
+  for (uint32_t v = meet; v != t; v = pred[1][v]) {
+    const Arc& a = downArcs[via[1][v]];
+    unpack(v, {pred[1][v], a.weight, a.middle}, path);
+  }
+  return path;
+}
+
+vector<long long> ContractionHierarchy::query(long long start,
+                                              long long target) const {
+  vector<uint32_t> dense = queryByIndex(ids.find(start), ids.find(target));
+  vector<long long> path;
+  path.reserve(dense.size());
+  for (uint32_t u : dense) {
+    path.push_back(ids.at(u));
+  }
+  return path;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "frozen_graph.h"
+#include "graph.h"
+#include "id_interner.h"
+
+using namespace std;
+
+/// @brief Contraction Hierarchies over a frozen graph. Preprocessing ranks
+///        every vertex and contracts them in that order, adding a shortcut
+///        `u -> w` whenever contracting `v` would otherwise lose the only
+///        shortest path `u -> v -> w`. A query is then a bidirectional search
+///        that only ever moves to higher-ranked vertices, and shortcuts are
+///        unpacked back into original vertices afterwards.
+///
+///        The exclusion set passed at build time plays the role of
+///        `dijkstra`'s `ignoreNodes` for every query: those vertices (e.g.
+///        buildings) may start or end a path but are never passed through.
+///        They are contracted first and never get shortcuts across them.
+class ContractionHierarchy {
+ public:
+  /// Empty hierarchy; every query returns an empty path
+  ContractionHierarchy() = default;
+
+  /// @brief Preprocess `G`. Runs a bounded local search per contracted
+  ///        vertex, so it is roughly linear in practice on road networks.
+  /// @param G graph to preprocess
+  /// @param noPassThrough vertex IDs that may only be path endpoints
+  ContractionHierarchy(const frozen_graph<long long, double>& G,
+                       const set<long long>& noPassThrough);
+
+  /// @brief Preprocess a mutable graph by freezing it first.
+  template <typename StorageT>
+  ContractionHierarchy(const graph<long long, double, StorageT>& G,
+                       const set<long long>& noPassThrough)
+      : ContractionHierarchy(frozen_graph<long long, double>(G),
+                             noPassThrough) {
+  }
+
+  /// @brief Shortest path from `start` to `target` that does not pass through
+  ///        any vertex in the build-time exclusion set.
+  /// @return node IDs on the path, or empty if unreachable or unknown
+  vector<long long> query(long long start, long long target) const;
+
+  /// @brief Same as above on dense vertex indices of the preprocessed graph.
+  vector<uint32_t> queryByIndex(uint32_t start, uint32_t target) const;
+
+  /// @brief Number of shortcut arcs added by preprocessing.
+  size_t numShortcuts() const {
+    return shortcuts;
+  }
+
+  /// @brief Contraction rank of dense vertex `u`; lower was contracted first.
+  uint32_t rankOf(uint32_t u) const {
+    return rank[u];
+  }
+
+ private:
+  /// Search-graph arc. `middle` is the contracted vertex a shortcut bypasses,
+  /// or `NONE` for an original edge.
+  struct Arc {
+    uint32_t other;
+    double weight;
+    uint32_t middle;
+  };
+
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  id_interner<long long> ids;
+  vector<uint32_t> rank;
+  vector<bool> passThrough;
+  // Arcs v -> other with rank[other] > rank[v], grouped by v
+  vector<uint32_t> upOffsets;
+  vector<Arc> upArcs;
+  // Arcs other -> v with rank[other] > rank[v], grouped by v
+  vector<uint32_t> downOffsets;
+  vector<Arc> downArcs;
+  size_t shortcuts = 0;
+
+  void unpack(uint32_t from, const Arc& arc, vector<uint32_t>& path) const;
+};
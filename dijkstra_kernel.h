@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "frozen_graph.h"
+#include "indexed_heap.h"
+#include "search_stats.h"
+#include "search_workspace.h"
+#include "vertex_mask.h"
+
+using namespace std;
+
+/// Which way a search follows edges: out of the source, or into it
+enum class SearchDirection { Forward, Backward };
+
+// Policies for `dijkstraSearch`. Each answers one question the search loop
+// would otherwise check at run time, so every combination compiles to its
+// own loop and the checks a caller does not need disappear.
+
+/// @brief Exclusion policy: nothing is excluded.
+struct NoExclusion {
+  static constexpr bool blocks(uint32_t) {
+    return false;
+  }
+};
+
+/// @brief Exclusion policy: the vertices flagged with `setIgnored`.
+struct ExcludeIgnored {
+  const SearchWorkspace& workspace;
+
+  bool blocks(uint32_t v) const {
+    return workspace.ignored(v);
+  }
+};
+
+/// @brief Exclusion policy: the vertices set in a `VertexMask`.
+struct ExcludeMask {
+  const VertexMask& mask;
+
+  bool blocks(uint32_t v) const {
+    return mask.test(v);
+  }
+};
+
+/// @brief Termination policy: stop once `target` is settled.
+struct StopAtTarget {
+  uint32_t target;
+
+  bool isGoal(uint32_t v) const {
+    return v == target;
+  }
+  bool done(uint32_t u) const {
+    return u == target;
+  }
+};
+
+/// @brief Termination policy: stop once every listed target is settled.
+///        Indices of `n` or more are skipped.
+class StopAfterTargets {
+ public:
+  StopAfterTargets(const vector<uint32_t>& targets, size_t n) {
+    for (uint32_t t : targets) {
+      if (t < n) {
+        pending.push_back(t);
+      }
+    }
+    sort(pending.begin(), pending.end());
+    pending.erase(unique(pending.begin(), pending.end()), pending.end());
+    remaining = pending.size();
+  }
+
+  bool isGoal(uint32_t v) const {
+    return binary_search(pending.begin(), pending.end(), v);
+  }
+  bool done(uint32_t u) {
+    if (isGoal(u)) {
+      remaining--;
+    }
+    return remaining == 0;
+  }
+
+ private:
+  vector<uint32_t> pending;  // sorted, unique
+  size_t remaining;
+};
+
+/// @brief Termination policy: settle everything reachable. Every vertex
+///        counts as a goal, so excluded vertices still get a distance.
+struct ExploreAll {
+  static constexpr bool isGoal(uint32_t) {
+    return true;
+  }
+  static constexpr bool done(uint32_t) {
+    return false;
+  }
+};
+
+/// @brief Recording policy: keep predecessors so paths can be unpacked.
+struct RecordPredecessors {
+  static void record(SearchWorkspace& workspace, uint32_t v, double d,
+                     uint32_t pred) {
+    workspace.update(v, d, pred);
+  }
+};
+
+/// @brief Recording policy: keep distances only; `predecessor` is
+///        meaningless afterwards.
+struct DistancesOnly {
+  static void record(SearchWorkspace& workspace, uint32_t v, double d,
+                     uint32_t) {
+    workspace.setDistance(v, d);
+  }
+};
+
+/// @brief Dijkstra's algorithm from `source`, with its behavior fixed at
+///        compile time by the policies above. Results stay in `workspace`:
+///        distances, settled flags and, when recorded, predecessors. Pops
+///        come out in `(distance, vertex)` order, so every combination
+///        that reaches a vertex gives it the same path.
+///
+///        Excluded vertices are never passed through. They are reached only
+///        if the termination policy names them as goals, and `source` may
+///        always be left.
+/// @tparam Direction follow out-edges (Forward) or in-edges (Backward)
+/// @param G graph
+/// @param source dense index to start from
+/// @param workspace search state, already `reset` for `G`; exclusion
+///                  flags set after the reset are respected
+/// @param pq queue with `pushOrDecrease`, `pop` and `empty`, such as the
+///           workspace's own `heap()` or an `indexed_heap` of another arity
+/// @param exclusion which vertices may not be passed through
+/// @param termination when to stop
+/// @param recording what to store per reached vertex
+/// @param stats `SearchStats` to add this search's counts to, or `NoStats`
+template <SearchDirection Direction = SearchDirection::Forward,
+          typename ExclusionT, typename TerminationT, typename RecordingT,
+          typename QueueT, typename StatsT>
+void dijkstraSearch(const frozen_graph<long long, double>& G, uint32_t source,
+                    SearchWorkspace& workspace, QueueT& pq,
+                    const ExclusionT& exclusion, TerminationT& termination,
+                    const RecordingT& recording, StatsT& stats) {
+  constexpr bool forward = Direction == SearchDirection::Forward;
+  stats.start();
+  pq.reserve(G.numVertices());
+  pq.clear();
+  recording.record(workspace, source, 0, SearchWorkspace::NONE);
+  pq.pushOrDecrease(source, 0);
+  stats.onPush(pq.size());
+
+  // The heap holds each vertex at most once, so no pop is ever stale
+  while (!pq.empty()) {
+    auto [currentDist, u] = pq.pop();
+    stats.onPop();
+    workspace.settle(u);
+    stats.onSettle();
+    if (termination.done(u)) {
+      break;
+    }
+    if (u != source && exclusion.blocks(u)) {
+      continue;
+    }
+
+    uint32_t begin = forward ? G.edgeBegin(u) : G.inEdgeBegin(u);
+    uint32_t end = forward ? G.edgeEnd(u) : G.inEdgeEnd(u);
+    for (uint32_t e = begin; e < end; e++) {
+      uint32_t v = forward ? G.edgeTarget(e) : G.inEdgeSource(e);
+      if (workspace.settled(v) ||
+          (exclusion.blocks(v) && !termination.isGoal(v))) {
+        continue;
+      }
+      double newDist =
+          currentDist + (forward ? G.edgeWeight(e) : G.inEdgeWeight(e));
+      stats.onRelax();
+      if (newDist < workspace.distance(v)) {
+        recording.record(workspace, v, newDist, u);
+        pq.pushOrDecrease(v, newDist);
+        stats.onPush(pq.size());
+      }
+    }
+  }
+  stats.stop();
+}
+
+/// @brief Same as above without statistics.
+template <SearchDirection Direction = SearchDirection::Forward,
+          typename ExclusionT, typename TerminationT, typename RecordingT,
+          typename QueueT>
+void dijkstraSearch(const frozen_graph<long long, double>& G, uint32_t source,
+                    SearchWorkspace& workspace, QueueT& pq,
+                    const ExclusionT& exclusion, TerminationT& termination,
+                    const RecordingT& recording) {
+  NoStats stats;
+  dijkstraSearch<Direction>(G, source, workspace, pq, exclusion, termination,
+                            recording, stats);
+}
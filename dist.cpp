@@ -1,6 +1,10 @@
 #include "dist.h"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
+
+using namespace std;
 
 double distBetween2Points(Coordinates p1, Coordinates p2) {
   // Reference: http://www8.nau.edu/cvm/latlon_formula.html
@@ -45,3 +49,43 @@ Coordinates centerBetween2Points(Coordinates p1, Coordinates p2) {
 
   return Coordinates(lat_ret, long_ret);
 }
+
+Coordinates centerOfPoints(const vector<Coordinates>& points) {
+  if (points.empty()) {
+    return Coordinates();
+  }
+  if (points.size() == 1) {
+    return points[0];
+  }
+  if (points.size() == 2) {
+    return centerBetween2Points(points[0], points[1]);
+  }
+
+  double PI = 3.14159265;
+  double x = 0, y = 0, z = 0;
+  for (const Coordinates& p : points) {
+    double lat_rad = p.lat * PI / 180.0;
+    double long_rad = p.lon * PI / 180.0;
+    x += cos(lat_rad) * cos(long_rad);
+    y += cos(lat_rad) * sin(long_rad);
+    z += sin(lat_rad);
+  }
+
+  double lat_ret = atan2(z, sqrt(x * x + y * y));
+  double long_ret = atan2(y, x);
+  return Coordinates(lat_ret * 180.0 / PI, long_ret * 180.0 / PI);
+}
+
+double haversineDistance(Coordinates p1, Coordinates p2) {
+  double PI = 3.14159265;
+  double earth_rad = 3963.1;  // statue miles, as above
+
+  double lat1_rad = p1.lat * PI / 180.0;
+  double lat2_rad = p2.lat * PI / 180.0;
+  double dlat = lat2_rad - lat1_rad;
+  double dlon = (p2.lon - p1.lon) * PI / 180.0;
+
+  double h = sin(dlat / 2) * sin(dlat / 2) +
+             cos(lat1_rad) * cos(lat2_rad) * sin(dlon / 2) * sin(dlon / 2);
+  return 2 * earth_rad * asin(sqrt(min(1.0, h)));
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 struct Coordinates {
   double lat;
   double lon;
@@ -23,3 +25,13 @@ double distBetween2Points(Coordinates p1, Coordinates p2);
 // Returns the center Coordinate between (lat1, lon1) and (lat2, lon2)
 // Reference: http://www.movable-type.co.uk/scripts/latlong.html
 Coordinates centerBetween2Points(Coordinates p1, Coordinates p2);
+
+// Returns the center of any number of points: the normalized average of
+// their positions on the sphere. Matches centerBetween2Points for 2 points,
+// and returns (0, 0) for none.
+Coordinates centerOfPoints(const std::vector<Coordinates>& points);
+
+// Returns the great-circle distance in miles between 2 points using the
+// haversine formula, on the same sphere as distBetween2Points. Unlike the
+// spherical law of cosines, it stays accurate for points a few feet apart.
+double haversineDistance(Coordinates p1, Coordinates p2);
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/// @brief Insert-only hash map using open addressing with linear probing.
+///        Entries live inline in one array, so there is no heap node per
+///        element. Supports the subset of the `unordered_map` interface that
+///        `graph` relies on (`find`, `operator[]`, `try_emplace`, `at`,
+///        iteration, `size`, `reserve`). Iterators are invalidated by inserts.
+/// @tparam K key type; must be default-constructible and copyable
+/// @tparam V mapped type; must be default-constructible
+/// @tparam Hash hash functor for K
+template <typename K, typename V, typename Hash = hash<K>>
+class flat_hash_map {
+ public:
+  using value_type = pair<K, V>;
+
+ private:
+  vector<value_type> slots;
+  vector<uint8_t> used;  // 1 if the slot holds an entry
+  size_t count = 0;
+
+  // std::hash is the identity for integers, so spread the bits before
+  // masking; otherwise sequential ids fill a single run of slots.
+  size_t home(const K& key) const {
+    uint64_t h = Hash{}(key);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return (h ^ (h >> 32)) & (slots.size() - 1);
+  }
+
+  // Slot holding `key`, or the empty slot where it would be inserted.
+  size_t probe(const K& key) const {
+    size_t i = home(key);
+    while (used[i] && !(slots[i].first == key)) {
+      i = (i + 1) & (slots.size() - 1);
+    }
+    return i;
+  }
+
+  void rehash(size_t capacity) {
+    vector<value_type> oldSlots(capacity);
+    vector<uint8_t> oldUsed(capacity, 0);
+    oldSlots.swap(slots);
+    oldUsed.swap(used);
+    for (size_t i = 0; i < oldSlots.size(); i++) {
+      if (oldUsed[i]) {
+        size_t j = probe(oldSlots[i].first);
+        slots[j] = std::move(oldSlots[i]);
+        used[j] = 1;
+      }
+    }
+  }
+
+  // Smallest power-of-two capacity keeping the load factor at most 7/8.
+  static size_t capacityFor(size_t n) {
+    size_t capacity = 8;
+    while (capacity * 7 / 8 < n) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  template <typename MapT, typename ValueT>
+  class basic_iterator {
+    MapT* map;
+    size_t i;
+
+    void skip() {
+      while (i < map->slots.size() && !map->used[i]) {
+        i++;
+      }
+    }
+
+   public:
+    basic_iterator(MapT* map, size_t i) : map(map), i(i) {
+      skip();
+    }
+
+    ValueT& operator*() const {
+      return map->slots[i];
+    }
+
+    ValueT* operator->() const {
+      return &map->slots[i];
+    }
+
+    basic_iterator& operator++() {
+      i++;
+      skip();
+      return *this;
+    }
+
+    bool operator==(const basic_iterator& other) const {
+      return i == other.i;
+    }
+
+    bool operator!=(const basic_iterator& other) const {
+      return i != other.i;
+    }
+  };
+
+ public:
+  using iterator = basic_iterator<flat_hash_map, value_type>;
+  using const_iterator = basic_iterator<const flat_hash_map, const value_type>;
+
+  flat_hash_map() = default;
+
+  /// @brief Make room for `n` entries without rehashing.
+  void reserve(size_t n) {
+    size_t capacity = capacityFor(n);
+    if (capacity > slots.size()) {
+      rehash(capacity);
+    }
+  }
+
+  /// @brief Insert `(key, V())` if `key` is missing.
+  /// @return iterator to the entry, and whether it was inserted
+  pair<iterator, bool> try_emplace(const K& key) {
+    if (capacityFor(count + 1) > slots.size()) {
+      rehash(capacityFor(count + 1));
+    }
+    size_t i = probe(key);
+    if (used[i]) {
+      return {iterator(this, i), false};
+    }
+    slots[i].first = key;
+    slots[i].second = V();
+    used[i] = 1;
+    count++;
+    return {iterator(this, i), true};
+  }
+
+  V& operator[](const K& key) {
+    return try_emplace(key).first->second;
+  }
+
+  iterator find(const K& key) {
+    if (count == 0) {
+      return end();
+    }
+    size_t i = probe(key);
+    return used[i] ? iterator(this, i) : end();
+  }
+
+  const_iterator find(const K& key) const {
+    if (count == 0) {
+      return end();
+    }
+    size_t i = probe(key);
+    return used[i] ? const_iterator(this, i) : end();
+  }
+
+  /// @brief Like `unordered_map::at`; throws `out_of_range` if missing.
+  const V& at(const K& key) const {
+    auto it = find(key);
+    if (it == end()) {
+      throw out_of_range("flat_hash_map::at");
+    }
+    return it->second;
+  }
+
+  size_t size() const {
+    return count;
+  }
+
+  bool empty() const {
+    return count == 0;
+  }
+
+  iterator begin() {
+    return iterator(this, 0);
+  }
+
+  iterator end() {
+    return iterator(this, slots.size());
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, slots.size());
+  }
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "graph.h"
+#include "id_interner.h"
+
+using namespace std;
+
+/// @brief Read-only snapshot of a `graph` in compressed-sparse-row form.
+///        Vertices are renumbered to dense indices `0..numVertices()-1`, and
+///        the out-edges of vertex `u` are the entries
+///        `[edgeBegin(u), edgeEnd(u))` of the target/weight arrays. A second
+///        CSR over the same edges, grouped by head, gives the in-edges of
+///        each vertex for searches that run backwards from a target.
+/// @tparam VertexT vertex type
+/// @tparam WeightT edge weight type
+template <typename VertexT, typename WeightT>
+class frozen_graph {
+ private:
+  id_interner<VertexT> ids;  // vertex <-> dense index
+  vector<uint32_t> offsets;  // size numVertices() + 1
+  vector<uint32_t> targets;
+  vector<WeightT> weights;
+  // Same edges grouped by head: the in-edges of v are
+  // [revOffsets[v], revOffsets[v + 1]) of sources/revWeights
+  vector<uint32_t> revOffsets;
+  vector<uint32_t> sources;
+  vector<WeightT> revWeights;
+  uint64_t stamp = nextGraphVersion();  // fixed: snapshots never change
+
+  // Counting sort of the forward arrays by target; O(|V| + |E|). Sources
+  // come out sorted within each row since forward rows are visited in order.
+  void buildReverse() {
+    size_t n = offsets.size() - 1;
+    revOffsets.assign(n + 1, 0);
+    for (uint32_t t : targets) {
+      revOffsets[t + 1]++;
+    }
+    for (size_t v = 0; v < n; v++) {
+      revOffsets[v + 1] += revOffsets[v];
+    }
+    sources.resize(targets.size());
+    revWeights.resize(targets.size());
+    vector<uint32_t> next(revOffsets.begin(), revOffsets.end() - 1);
+    for (uint32_t u = 0; u < n; u++) {
+      for (uint32_t e = offsets[u]; e < offsets[u + 1]; e++) {
+        uint32_t slot = next[targets[e]]++;
+        sources[slot] = u;
+        revWeights[slot] = weights[e];
+      }
+    }
+  }
+
+  template <typename StorageT>
+  void compact(const graph<VertexT, WeightT, StorageT>& G) {
+    offsets.reserve(ids.size() + 1);
+    targets.reserve(G.numEdges());
+    weights.reserve(G.numEdges());
+    offsets.push_back(0);
+
+    vector<pair<uint32_t, WeightT>> row;
+    for (const VertexT& v : ids.values()) {
+      row.clear();
+      G.forEachOutEdge(v, [&](const VertexT& n, const WeightT& w) {
+        row.emplace_back(ids.find(n), w);
+      });
+      sort(row.begin(), row.end(),
+           [](const auto& a, const auto& b) { return a.first < b.first; });
+      for (const auto& [t, w] : row) {
+        targets.push_back(t);
+        weights.push_back(w);
+      }
+      offsets.push_back(targets.size());
+    }
+    buildReverse();
+  }
+
+ public:
+  /// Sentinel returned when a vertex is not in the graph
+  static constexpr uint32_t NONE = id_interner<VertexT>::NONE;
+
+  /// Empty snapshot
+  frozen_graph() : offsets(1, 0), revOffsets(1, 0) {
+  }
+
+  /// @brief Compact `G` into CSR arrays. Runs in O(|V| log |V| + |E| log d).
+  ///        Dense indices follow the sorted order of the vertices, and each
+  ///        vertex's out-edges are sorted by target index.
+  /// @param G graph to snapshot; later changes to `G` are not reflected
+  template <typename StorageT>
+  explicit frozen_graph(const graph<VertexT, WeightT, StorageT>& G) {
+    vector<VertexT> sorted = G.getVertices();
+    sort(sorted.begin(), sorted.end());
+    ids.reserve(sorted.size());
+    for (const VertexT& v : sorted) {
+      ids.intern(v);
+    }
+    compact(G);
+  }
+
+  /// @brief Compact `G` using the dense numbering already assigned by
+  ///        `interner` (e.g. the one filled in by `buildGraph`). Vertices of
+  ///        `G` missing from `interner` are numbered after it.
+  template <typename StorageT>
+  frozen_graph(const graph<VertexT, WeightT, StorageT>& G,
+               const id_interner<VertexT>& interner)
+      : ids(interner) {
+    for (const VertexT& v : G.getVertices()) {
+      ids.intern(v);
+    }
+    compact(G);
+  }
+
+  /// @brief Adopt CSR arrays produced elsewhere (e.g. by a cache loader).
+  ///        `offsets` must have `interner.size() + 1` non-decreasing entries
+  ///        ending at `targets.size()`, and each row's targets must be sorted.
+  frozen_graph(id_interner<VertexT> interner, vector<uint32_t> offsets,
+               vector<uint32_t> targets, vector<WeightT> weights)
+      : ids(std::move(interner)),
+        offsets(std::move(offsets)),
+        targets(std::move(targets)),
+        weights(std::move(weights)) {
+    buildReverse();
+  }
+
+  /// @brief Version of this snapshot, as for `graph::version`. Copies
+  ///        share it since their contents are the same.
+  uint64_t version() const {
+    return stamp;
+  }
+
+  /// @brief Get the number of vertices. Runs in O(1).
+  size_t numVertices() const {
+    return ids.size();
+  }
+
+  /// @brief Get the number of directed edges. Runs in O(1).
+  size_t numEdges() const {
+    return targets.size();
+  }
+
+  /// @brief Dense index of `v`, or `NONE` if `v` is not in the graph.
+  uint32_t indexOf(const VertexT& v) const {
+    return ids.find(v);
+  }
+
+  /// @brief Vertex with dense index `u`.
+  const VertexT& vertexAt(uint32_t u) const {
+    return ids.at(u);
+  }
+
+  /// @brief The vertex <-> dense index mapping used by this snapshot.
+  const id_interner<VertexT>& interner() const {
+    return ids;
+  }
+
+  /// @brief First edge slot of `u`.
+  uint32_t edgeBegin(uint32_t u) const {
+    return offsets[u];
+  }
+
+  /// @brief One past the last edge slot of `u`.
+  uint32_t edgeEnd(uint32_t u) const {
+    return offsets[u + 1];
+  }
+
+  /// @brief Dense index of the head of edge slot `e`.
+  uint32_t edgeTarget(uint32_t e) const {
+    return targets[e];
+  }
+
+  /// @brief Weight of edge slot `e`.
+  const WeightT& edgeWeight(uint32_t e) const {
+    return weights[e];
+  }
+
+  /// @brief First in-edge slot of `v`.
+  uint32_t inEdgeBegin(uint32_t v) const {
+    return revOffsets[v];
+  }
+
+  /// @brief One past the last in-edge slot of `v`.
+  uint32_t inEdgeEnd(uint32_t v) const {
+    return revOffsets[v + 1];
+  }
+
+  /// @brief Dense index of the tail of in-edge slot `e`.
+  uint32_t inEdgeSource(uint32_t e) const {
+    return sources[e];
+  }
+
+  /// @brief Weight of in-edge slot `e`.
+  const WeightT& inEdgeWeight(uint32_t e) const {
+    return revWeights[e];
+  }
+
+  /// @brief Maybe get the weight of the edge `u -> v` by dense index. Runs in
+  ///        O(log deg(u)).
+  /// @return true if the edge exists, and weight is set
+  bool getWeightAt(uint32_t u, uint32_t v, WeightT& weight) const {
+    auto first = targets.begin() + offsets[u];
+    auto last = targets.begin() + offsets[u + 1];
+    auto it = lower_bound(first, last, v);
+    if (it == last || *it != v) {
+      return false;
+    }
+    weight = weights[it - targets.begin()];
+    return true;
+  }
+
+  /// @brief Same contract as `graph::getWeight`.
+  bool getWeight(const VertexT& from, const VertexT& to,
+                 WeightT& weight) const {
+    uint32_t u = indexOf(from);
+    uint32_t v = indexOf(to);
+    if (u == NONE || v == NONE) {
+      return false;
+    }
+    return getWeightAt(u, v, weight);
+  }
+};
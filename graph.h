@@ -1,36 +1,92 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <set>
+#include <span>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
+#include "flat_hash_map.h"
+
 using namespace std;
 
+/// @brief Storage policy backing `graph` with node-based `unordered_map`s.
+struct node_hash_storage {
+  template <typename K, typename V>
+  using map_type = unordered_map<K, V>;
+};
+
+/// @brief Storage policy backing `graph` with open-addressing
+///        `flat_hash_map`s: no heap node per vertex or edge.
+struct flat_hash_storage {
+  template <typename K, typename V>
+  using map_type = flat_hash_map<K, V>;
+};
+
+/// @brief Fresh process-wide graph version. Every graph state gets its own,
+///        so a cache that saw version `x` knows the contents are unchanged
+///        as long as the graph still reports `x`.
+inline uint64_t nextGraphVersion() {
+  static atomic<uint64_t> counter(0);
+  return ++counter;
+}
+
 /// @brief Simple directed graph using an adjacency list.
 /// @tparam VertexT vertex type
 /// @tparam WeightT edge weight type
-template <typename VertexT, typename WeightT>
+/// @tparam StorageT policy choosing the hash map used for the vertex table
+///                  and for each vertex's edge list
+template <typename VertexT, typename WeightT,
+          typename StorageT = node_hash_storage>
 class graph {
  private:
-  unordered_map<VertexT, unordered_map<VertexT, WeightT>> adjList; 
+  using EdgeMap = typename StorageT::template map_type<VertexT, WeightT>;
+  typename StorageT::template map_type<VertexT, EdgeMap> adjList;
   size_t edgeCount;
+  size_t edgesPerVertex;  // capacity hint for new edge lists, from reserve()
+  uint64_t stamp;         // renewed on every change, see version()
 
  public:
   /// Default constructor
   graph() {
     edgeCount = 0;
+    edgesPerVertex = 0;
+    stamp = nextGraphVersion();
+  }
+
+  /// @brief Version of the current contents; changes whenever a vertex or
+  ///        edge is added or overwritten, and differs between graphs.
+  uint64_t version() const {
+    return stamp;
+  }
+
+  /// @brief Pre-size the graph for about `vertices` vertices and `edges`
+  ///        directed edges, so bulk loading does not rehash incrementally.
+  ///        Edge lists created afterwards reserve the average degree.
+  /// @param vertices expected number of vertices
+  /// @param edges expected number of directed edges
+  void reserve(size_t vertices, size_t edges) {
+    adjList.reserve(vertices);
+    edgesPerVertex = vertices ? (edges + vertices - 1) / vertices : 0;
   }
 
   /// @brief Add the vertex v to the graph, must typically be O(1).
   /// @param v
   /// @return true if successfully added; false if it existed already
   bool addVertex(VertexT v) {
-    if (adjList.find(v) != adjList.end()) {
+    auto [it, inserted] = adjList.try_emplace(v);
+    if (!inserted) {
       return false;
     }
-    adjList[v] = {};
+    if (edgesPerVertex) {
+      it->second.reserve(edgesPerVertex);
+    }
+    stamp = nextGraphVersion();
     return true;
   }
     
@@ -42,16 +98,69 @@ class graph {
   /// @return true if successfully added or overwritten;
   ///         false if either vertices isn't in graph
   bool addEdge(VertexT from, VertexT to, WeightT weight) {
-    if (adjList.find(from) == adjList.end() || adjList.find(to) == adjList.end()) {
+    auto row = adjList.find(from);
+    if (row == adjList.end() || adjList.find(to) == adjList.end()) {
       return false;  // Either vertex doesn't exist
     }
-    if (adjList[from].find(to) == adjList[from].end()) {
-    edgeCount++;
+    auto [edge, inserted] = row->second.try_emplace(to);
+    if (inserted) {
+      edgeCount++;
     }
-  
-    adjList[from][to] = weight;
+    edge->second = weight;
+    stamp = nextGraphVersion();
     return true;
-    
+  }
+
+  /// @brief Add or overwrite many directed edges at once. The list is sorted
+  ///        by source so each source row is looked up and grown once; when
+  ///        the same (from, to) pair appears more than once, the last
+  ///        occurrence wins, exactly as with repeated `addEdge` calls. Runs in
+  ///        O(k log k) for k edges.
+  /// @param edges (from, to, weight) triples
+  /// @return number of edges added or overwritten; edges with a missing
+  ///         endpoint are skipped
+  size_t addEdges(span<const tuple<VertexT, VertexT, WeightT>> edges) {
+    vector<tuple<VertexT, VertexT, WeightT>> sorted(edges.begin(),
+                                                     edges.end());
+    stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+      return tie(get<0>(a), get<1>(a)) < tie(get<0>(b), get<1>(b));
+    });
+
+    size_t added = 0;
+    size_t i = 0;
+    while (i < sorted.size()) {
+      size_t groupEnd = i;
+      while (groupEnd < sorted.size() &&
+             get<0>(sorted[groupEnd]) == get<0>(sorted[i])) {
+        groupEnd++;
+      }
+
+      auto row = adjList.find(get<0>(sorted[i]));
+      if (row != adjList.end()) {
+        row->second.reserve(row->second.size() + (groupEnd - i));
+        for (size_t j = i; j < groupEnd; j++) {
+          // Skip all but the last occurrence of a duplicate pair
+          if (j + 1 < groupEnd && get<1>(sorted[j + 1]) == get<1>(sorted[j])) {
+            continue;
+          }
+          const auto& [from, to, weight] = sorted[j];
+          if (adjList.find(to) == adjList.end()) {
+            continue;
+          }
+          auto [edge, inserted] = row->second.try_emplace(to);
+          if (inserted) {
+            edgeCount++;
+          }
+          edge->second = weight;
+          added++;
+        }
+      }
+      i = groupEnd;
+    }
+    if (added) {
+      stamp = nextGraphVersion();
+    }
+    return added;
   }
 
   /// @brief Maybe get the weight associated with a given edge, must typically
@@ -62,12 +171,13 @@ class graph {
   /// @return true if the edge exists, and weight is set;
   ///         false if the edge does not exist
   bool getWeight(VertexT from, VertexT to, WeightT& weight) const {
-    if (adjList.find(from) == adjList.end()) {
+    auto edges = adjList.find(from);
+    if (edges == adjList.end()) {
       return false; 
     }
 
-    auto check = adjList.at(from).find(to);
-    if (check != adjList.at(from).end()) {
+    auto check = edges->second.find(to);
+    if (check != edges->second.end()) {
       weight = check->second;
       return true;
     }
@@ -90,6 +200,22 @@ class graph {
     return S;
   }
 
+  /// @brief Call `fn(to, weight)` for every out-edge of v, without copying
+  ///        the neighbor set. Runs in O(deg(v)). `fn` must not modify the
+  ///        graph.
+  /// @param v
+  /// @param fn callable taking `(const VertexT&, const WeightT&)`
+  template <typename Fn>
+  void forEachOutEdge(const VertexT& v, Fn&& fn) const {
+    auto edges = adjList.find(v);
+    if (edges == adjList.end()) {
+      return;
+    }
+    for (const auto& [to, weight] : edges->second) {
+      fn(to, weight);
+    }
+  }
+
   /// @brief Return a vector containing all vertices in the graph
   vector<VertexT> getVertices() const {
     vector<VertexT> vertices;
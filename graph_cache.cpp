@@ -0,0 +1,425 @@
+#include "graph_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = {'O', 'S', 'M', 'G', 'R', 'A', 'P', 'H'};
+const char MATRIX_MAGIC[8] = {'O', 'S', 'M', 'M', 'A', 'T', 'R', 'X'};
+
+// Fixed-size file header. All sections after it are padded to 8 bytes.
+struct CacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  uint64_t sourceSize;
+  uint64_t sourceHash;
+  uint64_t numVertices;
+  uint64_t numEdges;
+  uint64_t numBuildings;
+  uint64_t stringBytes;
+  uint64_t payloadHash;
+};
+
+struct MatrixHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  uint64_t graphHash;
+  uint64_t numVertices;
+  uint64_t numBuildings;
+  uint64_t payloadHash;
+};
+
+struct CachedBuilding {
+  int64_t id;
+  double lat;
+  double lon;
+  uint64_t nameOffset;  // abbreviation follows the name in the string blob
+  uint32_t nameLength;
+  uint32_t abbrLength;
+};
+
+// 64-bit FNV-1a, continued from `h`
+uint64_t fnv1a(const char* data, size_t n, uint64_t h = 14695981039346656037ULL) {
+  for (size_t i = 0; i < n; i++) {
+    h ^= (unsigned char)data[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+size_t padded(size_t bytes) {
+  return (bytes + 7) & ~size_t(7);
+}
+
+// Byte size of everything after the header, or 0 on overflow-ish input
+size_t payloadSize(const CacheHeader& h) {
+  if (h.numVertices >= UINT32_MAX || h.numEdges >= UINT32_MAX) {
+    return 0;
+  }
+  return padded(h.numVertices * sizeof(int64_t)) +
+         padded(h.numVertices * 2 * sizeof(double)) +
+         padded((h.numVertices + 1) * sizeof(uint32_t)) +
+         padded(h.numEdges * sizeof(uint32_t)) +
+         padded(h.numEdges * sizeof(double)) +
+         padded(h.numBuildings * sizeof(CachedBuilding)) +
+         padded(h.stringBytes);
+}
+
+// Size and hash of the source file, so edits to the JSON invalidate caches
+bool fingerprint(const string& path, uint64_t& size, uint64_t& hash) {
+  ifstream in(path, ios::binary);
+  if (!in) {
+    return false;
+  }
+  size = 0;
+  hash = fnv1a(nullptr, 0);
+  vector<char> buffer(1 << 16);
+  while (in) {
+    in.read(buffer.data(), buffer.size());
+    size_t n = in.gcount();
+    hash = fnv1a(buffer.data(), n, hash);
+    size += n;
+  }
+  return true;
+}
+
+// Hash of the graph and catalog a building matrix was computed for
+uint64_t graphHash(const frozen_graph<long long, double>& G,
+                   const vector<BuildingInfo>& buildings) {
+  uint64_t h = fnv1a(nullptr, 0);
+  auto mix = [&h](const auto& value) {
+    h = fnv1a(reinterpret_cast<const char*>(&value), sizeof(value), h);
+  };
+  for (uint32_t u = 0; u < G.numVertices(); u++) {
+    mix((int64_t)G.vertexAt(u));
+    mix(G.edgeEnd(u) - G.edgeBegin(u));
+    for (uint32_t e = G.edgeBegin(u); e < G.edgeEnd(u); e++) {
+      mix(G.edgeTarget(e));
+      mix(G.edgeWeight(e));
+    }
+  }
+  for (const BuildingInfo& b : buildings) {
+    mix((int64_t)b.id);
+  }
+  return h;
+}
+
+void append(string& out, const void* data, size_t bytes) {
+  out.append(static_cast<const char*>(data), bytes);
+  out.append(padded(bytes) - bytes, '\0');
+}
+
+// Read-only mapping of a whole file, unmapped on destruction
+class MappedFile {
+ public:
+  const char* data = nullptr;
+  size_t size = 0;
+
+  explicit MappedFile(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        data = static_cast<const char*>(p);
+        size = st.st_size;
+      }
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data) {
+      munmap(const_cast<char*>(data), size);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+};
+
+// Copy `count` elements out of the mapping and advance the cursor
+template <typename T>
+vector<T> take(const char*& cursor, size_t count) {
+  vector<T> values(count);
+  if (count) {
+    memcpy(values.data(), cursor, count * sizeof(T));
+  }
+  cursor += padded(count * sizeof(T));
+  return values;
+}
+
+}  // namespace
+
+bool writeGraphCache(const string& cachePath, const string& sourcePath,
+                     const frozen_graph<long long, double>& G,
+                     const vector<BuildingInfo>& buildings,
+                     const vector<Coordinates>& coords) {
+  CacheHeader header = {};
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = GRAPH_CACHE_VERSION;
+  header.headerSize = sizeof(CacheHeader);
+  if (!fingerprint(sourcePath, header.sourceSize, header.sourceHash)) {
+    return false;
+  }
+
+  size_t n = G.numVertices();
+  vector<int64_t> ids(n);
+  vector<double> latLon(2 * n, 0.0);
+  vector<uint32_t> offsets(n + 1);
+  vector<uint32_t> targets;
+  vector<double> weights;
+  targets.reserve(G.numEdges());
+  weights.reserve(G.numEdges());
+  for (uint32_t u = 0; u < n; u++) {
+    ids[u] = G.vertexAt(u);
+    if (u < coords.size()) {
+      latLon[2 * u] = coords[u].lat;
+      latLon[2 * u + 1] = coords[u].lon;
+    }
+    offsets[u] = targets.size();
+    for (uint32_t e = G.edgeBegin(u); e < G.edgeEnd(u); e++) {
+      targets.push_back(G.edgeTarget(e));
+      weights.push_back(G.edgeWeight(e));
+    }
+  }
+  offsets[n] = targets.size();
+
+  string strings;
+  vector<CachedBuilding> cached;
+  cached.reserve(buildings.size());
+  for (const BuildingInfo& b : buildings) {
+    CachedBuilding c = {};
+    c.id = b.id;
+    c.lat = b.location.lat;
+    c.lon = b.location.lon;
+    c.nameOffset = strings.size();
+    c.nameLength = b.name.size();
+    c.abbrLength = b.abbr.size();
+    strings += b.name;
+    strings += b.abbr;
+    cached.push_back(c);
+  }
+
+  header.numVertices = n;
+  header.numEdges = targets.size();
+  header.numBuildings = cached.size();
+  header.stringBytes = strings.size();
+
+  string payload;
+  payload.reserve(payloadSize(header));
+  append(payload, ids.data(), ids.size() * sizeof(int64_t));
+  append(payload, latLon.data(), latLon.size() * sizeof(double));
+  append(payload, offsets.data(), offsets.size() * sizeof(uint32_t));
+  append(payload, targets.data(), targets.size() * sizeof(uint32_t));
+  append(payload, weights.data(), weights.size() * sizeof(double));
+  append(payload, cached.data(), cached.size() * sizeof(CachedBuilding));
+  append(payload, strings.data(), strings.size());
+  header.payloadHash = fnv1a(payload.data(), payload.size());
+
+  ofstream out(cachePath, ios::binary | ios::trunc);
+  if (!out) {
+    return false;
+  }
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(payload.data(), payload.size());
+  return bool(out);
+}
+
+bool loadGraphCache(const string& cachePath, const string& sourcePath,
+                    frozen_graph<long long, double>& G,
+                    vector<BuildingInfo>& buildings,
+                    vector<Coordinates>& coords) {
+  MappedFile file(cachePath);
+  if (!file.data || file.size < sizeof(CacheHeader)) {
+    return false;
+  }
+
+  CacheHeader header;
+  memcpy(&header, file.data, sizeof(header));
+  if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != GRAPH_CACHE_VERSION ||
+      header.headerSize != sizeof(CacheHeader)) {
+    return false;
+  }
+
+  size_t expected = payloadSize(header);
+  if (expected == 0 || file.size != sizeof(CacheHeader) + expected) {
+    return false;
+  }
+
+  // Cheap size check first, then the content hash
+  struct stat st;
+  if (stat(sourcePath.c_str(), &st) != 0 ||
+      (uint64_t)st.st_size != header.sourceSize) {
+    return false;
+  }
+  uint64_t sourceSize, sourceHash;
+  if (!fingerprint(sourcePath, sourceSize, sourceHash) ||
+      sourceSize != header.sourceSize || sourceHash != header.sourceHash) {
+    return false;
+  }
+
+  const char* cursor = file.data + sizeof(CacheHeader);
+  if (fnv1a(cursor, expected) != header.payloadHash) {
+    return false;
+  }
+
+  size_t n = header.numVertices;
+  vector<int64_t> ids = take<int64_t>(cursor, n);
+  vector<double> latLon = take<double>(cursor, 2 * n);
+  vector<uint32_t> offsets = take<uint32_t>(cursor, n + 1);
+  vector<uint32_t> targets = take<uint32_t>(cursor, header.numEdges);
+  vector<double> weights = take<double>(cursor, header.numEdges);
+  vector<CachedBuilding> cached =
+      take<CachedBuilding>(cursor, header.numBuildings);
+  const char* strings = cursor;
+
+  // Structural checks so a consistent-but-wrong file cannot index out of
+  // bounds later
+  if (offsets[0] != 0 || offsets[n] != header.numEdges) {
+    return false;
+  }
+  for (size_t u = 0; u < n; u++) {
+    if (offsets[u] > offsets[u + 1]) {
+      return false;
+    }
+  }
+  for (uint32_t t : targets) {
+    if (t >= n) {
+      return false;
+    }
+  }
+  for (const CachedBuilding& c : cached) {
+    if (c.nameOffset + c.nameLength + c.abbrLength > header.stringBytes) {
+      return false;
+    }
+  }
+
+  id_interner<long long> interner;
+  interner.reserve(n);
+  for (int64_t id : ids) {
+    interner.intern(id);
+  }
+  if (interner.size() != n) {
+    return false;  // duplicate vertex ids
+  }
+
+  vector<Coordinates> loadedCoords(n);
+  for (size_t u = 0; u < n; u++) {
+    loadedCoords[u] = Coordinates(latLon[2 * u], latLon[2 * u + 1]);
+  }
+
+  vector<BuildingInfo> loadedBuildings;
+  loadedBuildings.reserve(cached.size());
+  for (const CachedBuilding& c : cached) {
+    const char* name = strings + c.nameOffset;
+    loadedBuildings.emplace_back(c.id, Coordinates(c.lat, c.lon),
+                                 string(name, c.nameLength),
+                                 string(name + c.nameLength, c.abbrLength));
+  }
+
+  G = frozen_graph<long long, double>(std::move(interner), std::move(offsets),
+                                      std::move(targets), std::move(weights));
+  buildings = std::move(loadedBuildings);
+  coords = std::move(loadedCoords);
+  return true;
+}
+
+bool writeBuildingMatrix(const string& path,
+                         const frozen_graph<long long, double>& G,
+                         const vector<BuildingInfo>& buildings,
+                         const BuildingMatrix& matrix) {
+  if (!matrix.covers(G.numVertices(), buildings.size())) {
+    return false;
+  }
+
+  MatrixHeader header = {};
+  memcpy(header.magic, MATRIX_MAGIC, sizeof(MATRIX_MAGIC));
+  header.version = BUILDING_MATRIX_VERSION;
+  header.headerSize = sizeof(MatrixHeader);
+  header.graphHash = graphHash(G, buildings);
+  header.numVertices = G.numVertices();
+  header.numBuildings = buildings.size();
+
+  const vector<uint32_t>& vertices = matrix.vertices();
+  const vector<double>& distances = matrix.distanceTable();
+  const vector<uint32_t>& nextHops = matrix.nextHopTable();
+  string payload;
+  append(payload, vertices.data(), vertices.size() * sizeof(uint32_t));
+  append(payload, distances.data(), distances.size() * sizeof(double));
+  append(payload, nextHops.data(), nextHops.size() * sizeof(uint32_t));
+  header.payloadHash = fnv1a(payload.data(), payload.size());
+
+  ofstream out(path, ios::binary | ios::trunc);
+  if (!out) {
+    return false;
+  }
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(payload.data(), payload.size());
+  return bool(out);
+}
+
+bool loadBuildingMatrix(const string& path,
+                        const frozen_graph<long long, double>& G,
+                        const vector<BuildingInfo>& buildings,
+                        BuildingMatrix& matrix) {
+  MappedFile file(path);
+  if (!file.data || file.size < sizeof(MatrixHeader)) {
+    return false;
+  }
+
+  MatrixHeader header;
+  memcpy(&header, file.data, sizeof(header));
+  size_t n = G.numVertices();
+  size_t b = buildings.size();
+  if (memcmp(header.magic, MATRIX_MAGIC, sizeof(MATRIX_MAGIC)) != 0 ||
+      header.version != BUILDING_MATRIX_VERSION ||
+      header.headerSize != sizeof(MatrixHeader) || header.numVertices != n ||
+      header.numBuildings != b) {
+    return false;
+  }
+
+  size_t expected = padded(b * sizeof(uint32_t)) +
+                    padded(b * b * sizeof(double)) +
+                    padded(b * n * sizeof(uint32_t));
+  const char* cursor = file.data + sizeof(MatrixHeader);
+  if (file.size != sizeof(MatrixHeader) + expected ||
+      fnv1a(cursor, expected) != header.payloadHash ||
+      graphHash(G, buildings) != header.graphHash) {
+    return false;
+  }
+
+  vector<uint32_t> vertices = take<uint32_t>(cursor, b);
+  vector<double> distances = take<double>(cursor, b * b);
+  vector<uint32_t> nextHops = take<uint32_t>(cursor, b * n);
+  for (uint32_t hop : nextHops) {
+    if (hop >= n && hop != BuildingMatrix::NONE) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < b; i++) {
+    if (vertices[i] != G.indexOf(buildings[i].id)) {
+      return false;
+    }
+  }
+
+  matrix = BuildingMatrix(n, std::move(vertices), std::move(distances),
+                          std::move(nextHops));
+  return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "application.h"
+#include "building_matrix.h"
+#include "dist.h"
+#include "frozen_graph.h"
+
+using namespace std;
+
+/// Bumped whenever the on-disk layout changes; older caches are rejected.
+constexpr uint32_t GRAPH_CACHE_VERSION = 1;
+constexpr uint32_t BUILDING_MATRIX_VERSION = 1;
+
+/// @brief Write a binary snapshot of a built map to `cachePath`: the frozen
+///        graph, the building catalog, and per-vertex coordinates. The
+///        snapshot is stamped with the size and hash of `sourcePath` so a
+///        later load can tell whether it is stale.
+/// @param cachePath file to (over)write
+/// @param sourcePath JSON the map was built from
+/// @param G frozen graph to store
+/// @param buildings building catalog
+/// @param coords coordinates indexed by `G`'s dense indices
+/// @return true on success; false if either file could not be accessed
+bool writeGraphCache(const string& cachePath, const string& sourcePath,
+                     const frozen_graph<long long, double>& G,
+                     const vector<BuildingInfo>& buildings,
+                     const vector<Coordinates>& coords);
+
+/// @brief Memory-map `cachePath` and rebuild the map from its fixed-layout
+///        arrays, with no JSON parsing and no distance computations.
+/// @param cachePath file written by `writeGraphCache`
+/// @param sourcePath JSON the cache must correspond to
+/// @param G resulting graph, by reference
+/// @param buildings resulting building catalog, by reference
+/// @param coords resulting coordinates, by reference
+/// @return true on success; false if the cache is missing, truncated,
+///         corrupt, from another format version, or stale with respect to
+///         `sourcePath`. Outputs are untouched on failure.
+bool loadGraphCache(const string& cachePath, const string& sourcePath,
+                    frozen_graph<long long, double>& G,
+                    vector<BuildingInfo>& buildings,
+                    vector<Coordinates>& coords);
+
+/// @brief Write `matrix` to `path`, stamped with a hash of the graph and
+///        building catalog it was computed for.
+/// @return true on success
+bool writeBuildingMatrix(const string& path,
+                         const frozen_graph<long long, double>& G,
+                         const vector<BuildingInfo>& buildings,
+                         const BuildingMatrix& matrix);
+
+/// @brief Load a table written by `writeBuildingMatrix`.
+/// @param path file to read
+/// @param G graph the table must have been computed for
+/// @param buildings catalog the table must have been computed for
+/// @param matrix resulting table, by reference
+/// @return true on success; false if the file is missing, corrupt, from
+///         another format version, or was computed for a different graph or
+///         catalog. `matrix` is untouched on failure.
+bool loadBuildingMatrix(const string& path,
+                        const frozen_graph<long long, double>& G,
+                        const vector<BuildingInfo>& buildings,
+                        BuildingMatrix& matrix);
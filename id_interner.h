@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/// @brief Bidirectional mapping between sparse vertex ids (e.g. 64-bit OSM
+///        ids) and contiguous `uint32_t` indices `0..size()-1`, assigned in
+///        first-seen order. Lets per-vertex search state live in plain arrays.
+/// @tparam VertexT vertex id type
+template <typename VertexT>
+class id_interner {
+ private:
+  vector<VertexT> ids;
+  unordered_map<VertexT, uint32_t> index;
+
+ public:
+  /// Sentinel returned by `find` for ids that were never interned
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  /// @brief Pre-size both directions of the mapping.
+  void reserve(size_t n) {
+    ids.reserve(n);
+    index.reserve(n);
+  }
+
+  /// @brief Get the index of `v`, assigning the next free one if `v` is new.
+  ///        Runs in O(1) on average.
+  uint32_t intern(const VertexT& v) {
+    auto [it, inserted] = index.try_emplace(v, ids.size());
+    if (inserted) {
+      ids.push_back(v);
+    }
+    return it->second;
+  }
+
+  /// @brief Get the index of `v`, or `NONE` if it was never interned.
+  uint32_t find(const VertexT& v) const {
+    auto it = index.find(v);
+    return it == index.end() ? NONE : it->second;
+  }
+
+  /// @brief Reverse lookup: the id that was assigned index `i`.
+  const VertexT& at(uint32_t i) const {
+    return ids[i];
+  }
+
+  /// @brief Number of interned ids.
+  size_t size() const {
+    return ids.size();
+  }
+
+  /// @brief All interned ids, in index order.
+  const vector<VertexT>& values() const {
+    return ids;
+  }
+};
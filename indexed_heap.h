@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/// @brief Min-heap of dense vertex indices with decrease-key. Each vertex is
+///        in the heap at most once, so its size is bounded by the number of
+///        vertices, unlike a `priority_queue` with lazy deletion that keeps
+///        stale duplicates around.
+///
+///        Entries are ordered by `(key, vertex)`, so pops come out in the same
+///        order as a `priority_queue` of `pair<KeyT, uint32_t>` would yield its
+///        live entries. `position` is never cleared: an entry counts only if
+///        the heap slot it points at holds that same vertex, so `clear()`
+///        does not cost O(V).
+/// @tparam KeyT priority type
+/// @tparam Arity children per node; 4 keeps the tree shallow while a node's
+///         children still share a cache line or two
+template <typename KeyT, unsigned Arity = 4>
+class indexed_heap {
+ private:
+  vector<pair<KeyT, uint32_t>> heap;
+  vector<uint32_t> position;
+
+  void place(size_t i, const pair<KeyT, uint32_t>& entry) {
+    heap[i] = entry;
+    position[entry.second] = i;
+  }
+
+  void siftUp(size_t i) {
+    pair<KeyT, uint32_t> entry = heap[i];
+    while (i > 0) {
+      size_t parent = (i - 1) / Arity;
+      if (!(entry < heap[parent])) {
+        break;
+      }
+      place(i, heap[parent]);
+      i = parent;
+    }
+    place(i, entry);
+  }
+
+  void siftDown(size_t i) {
+    pair<KeyT, uint32_t> entry = heap[i];
+    while (true) {
+      size_t first = i * Arity + 1;
+      if (first >= heap.size()) {
+        break;
+      }
+      size_t last = min(first + Arity, heap.size());
+      size_t best = first;
+      for (size_t c = first + 1; c < last; c++) {
+        if (heap[c] < heap[best]) {
+          best = c;
+        }
+      }
+      if (!(heap[best] < entry)) {
+        break;
+      }
+      place(i, heap[best]);
+      i = best;
+    }
+    place(i, entry);
+  }
+
+ public:
+  /// @brief Make room for vertices `[0, n)`.
+  void reserve(size_t n) {
+    if (position.size() < n) {
+      position.resize(n, 0);
+    }
+    heap.reserve(n);
+  }
+
+  /// @brief Remove every entry. O(1).
+  void clear() {
+    heap.clear();
+  }
+
+  bool empty() const {
+    return heap.empty();
+  }
+
+  size_t size() const {
+    return heap.size();
+  }
+
+  /// @brief Whether `v` is currently in the heap.
+  bool contains(uint32_t v) const {
+    return v < position.size() && position[v] < heap.size() &&
+           heap[position[v]].second == v;
+  }
+
+  /// @brief Insert `v` with `key`, or lower its key if it is already in the
+  ///        heap. Keys never go up.
+  /// @return true if the heap changed
+  bool pushOrDecrease(uint32_t v, const KeyT& key) {
+    if (contains(v)) {
+      size_t i = position[v];
+      if (!(key < heap[i].first)) {
+        return false;
+      }
+      heap[i].first = key;
+      siftUp(i);
+      return true;
+    }
+    heap.emplace_back(key, v);
+    position[v] = heap.size() - 1;
+    siftUp(heap.size() - 1);
+    return true;
+  }
+
+  /// @brief Smallest `(key, vertex)` entry.
+  const pair<KeyT, uint32_t>& top() const {
+    return heap.front();
+  }
+
+  /// @brief Remove and return the smallest entry.
+  pair<KeyT, uint32_t> pop() {
+    pair<KeyT, uint32_t> result = heap.front();
+    heap.front() = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+      siftDown(0);
+    }
+    return result;
+  }
+};
@@ -0,0 +1,132 @@
+#include "landmarks.h"
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "astar.h"
+#include "parallel.h"
+
+using namespace std;
+
+namespace {
+
+const double INF = numeric_limits<double>::max();
+
+/// Single-source distances from `source`, over in-edges if `reverse`.
+vector<double> distancesFrom(const frozen_graph<long long, double>& G,
+                             uint32_t source, bool reverse) {
+  vector<double> dist(G.numVertices(), INF);
+  using Entry = pair<double, uint32_t>;
+  priority_queue<Entry, vector<Entry>, greater<>> pq;
+  dist[source] = 0;
+  pq.emplace(0, source);
+
+  while (!pq.empty()) {
+    auto [d, u] = pq.top();
+    pq.pop();
+    if (d > dist[u]) {
+      continue;
+    }
+    uint32_t begin = reverse ? G.inEdgeBegin(u) : G.edgeBegin(u);
+    uint32_t end = reverse ? G.inEdgeEnd(u) : G.edgeEnd(u);
+    for (uint32_t e = begin; e < end; e++) {
+      uint32_t v = reverse ? G.inEdgeSource(e) : G.edgeTarget(e);
+      double nd = d + (reverse ? G.inEdgeWeight(e) : G.edgeWeight(e));
+      if (nd < dist[v]) {
+        dist[v] = nd;
+        pq.emplace(nd, v);
+      }
+    }
+  }
+  return dist;
+}
+
+/// Reachable vertex with the largest finite `dist`, lowest index on ties.
+uint32_t farthest(const vector<double>& dist) {
+  uint32_t best = 0;
+  for (uint32_t v = 1; v < dist.size(); v++) {
+    if (dist[v] != INF && (dist[best] == INF || dist[v] > dist[best])) {
+      best = v;
+    }
+  }
+  return best;
+}
+
+}  // namespace
+
+Landmarks::Landmarks(const frozen_graph<long long, double>& G, size_t count,
+                     unsigned threads) {
+  size_t n = G.numVertices();
+  if (n == 0 || count == 0) {
+    return;
+  }
+
+  // Farthest-point selection: start from the vertex farthest from vertex 0,
+  // then repeatedly take the vertex farthest from every landmark so far
+  vector<vector<double>> forward;
+  vector<double> nearest = distancesFrom(G, 0, false);
+  vector<bool> chosen(n, false);
+  for (size_t l = 0; l < count; l++) {
+    uint32_t next = farthest(nearest);
+    if (chosen[next]) {
+      break;
+    }
+    chosen[next] = true;
+    vertices.push_back(next);
+    forward.push_back(distancesFrom(G, next, false));
+    if (l == 0) {
+      nearest = forward.back();
+    } else {
+      for (size_t v = 0; v < n; v++) {
+        nearest[v] = min(nearest[v], forward.back()[v]);
+      }
+    }
+  }
+
+  size_t k = vertices.size();
+  vector<vector<double>> backward(k);
+  parallelFor(k, threads, [&](size_t begin, size_t end) {
+    for (size_t l = begin; l < end; l++) {
+      backward[l] = distancesFrom(G, vertices[l], true);
+    }
+  });
+
+  fromLandmark.resize(n * k);
+  toLandmark.resize(n * k);
+  for (size_t v = 0; v < n; v++) {
+    for (size_t l = 0; l < k; l++) {
+      fromLandmark[v * k + l] = forward[l][v];
+      toLandmark[v * k + l] = backward[l][v];
+    }
+  }
+}
+
+vector<uint32_t> altSearchByIndex(const frozen_graph<long long, double>& G,
+                                  const Landmarks& landmarks, uint32_t s,
+                                  uint32_t t,
+                                  const set<long long>& ignoreNodes) {
+  if (!landmarks.covers(G.numVertices())) {
+    return goalDirectedSearch(G, s, t, ignoreNodes,
+                              [](uint32_t, uint32_t) { return 0.0; });
+  }
+  return goalDirectedSearch(G, s, t, ignoreNodes,
+                            [&landmarks](uint32_t u, uint32_t v) {
+                              return landmarks.lowerBound(u, v);
+                            });
+}
+
+vector<long long> altSearch(const frozen_graph<long long, double>& G,
+                            const Landmarks& landmarks, long long start,
+                            long long target,
+                            const set<long long>& ignoreNodes) {
+  vector<uint32_t> dense = altSearchByIndex(G, landmarks, G.indexOf(start),
+                                            G.indexOf(target), ignoreNodes);
+  vector<long long> path;
+  path.reserve(dense.size());
+  for (uint32_t u : dense) {
+    path.push_back(G.vertexAt(u));
+  }
+  return path;
+}
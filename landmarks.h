@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "frozen_graph.h"
+
+using namespace std;
+
+/// @brief ALT preprocessing: exact distances to and from a few landmark
+///        vertices. By the triangle inequality, `d(L, t) - d(L, u)` and
+///        `d(u, L) - d(t, L)` are both lower bounds on `d(u, t)`. Unlike
+///        straight-line distance, these follow the actual network, so they
+///        stay tight around obstacles such as expressways and rail lines.
+///
+///        Distances are over the whole graph, ignoring any vertices a query
+///        later excludes. Excluding vertices only makes paths longer, so the
+///        bounds remain admissible for every `ignoreNodes` set.
+struct Landmarks {
+  vector<uint32_t> vertices;  // dense indices of the landmarks
+  // Row-major by vertex: fromLandmark[v * count + l] is d(landmark l, v),
+  // toLandmark[v * count + l] is d(v, landmark l); INF if unreachable
+  vector<double> fromLandmark;
+  vector<double> toLandmark;
+
+  Landmarks() = default;
+
+  /// @brief Pick up to `count` landmarks by farthest-point selection and
+  ///        compute their distance arrays: 2 full Dijkstra runs per landmark.
+  /// @param G graph
+  /// @param count number of landmarks wanted
+  /// @param threads worker threads for the distance computations
+  Landmarks(const frozen_graph<long long, double>& G, size_t count,
+            unsigned threads = 1);
+
+  /// @brief Whether the landmarks were computed for a graph with `n` vertices.
+  bool covers(size_t n) const {
+    return !vertices.empty() && fromLandmark.size() == n * vertices.size();
+  }
+
+  /// @brief Lower bound on the length of any path from `u` to `t`.
+  double lowerBound(uint32_t u, uint32_t t) const {
+    const double INF = numeric_limits<double>::max();
+    size_t k = vertices.size();
+    const double* fromU = &fromLandmark[u * k];
+    const double* fromT = &fromLandmark[t * k];
+    const double* toU = &toLandmark[u * k];
+    const double* toT = &toLandmark[t * k];
+    double bound = 0;
+    for (size_t l = 0; l < k; l++) {
+      if (fromU[l] != INF && fromT[l] != INF) {
+        bound = max(bound, fromT[l] - fromU[l]);
+      }
+      if (toU[l] != INF && toT[l] != INF) {
+        bound = max(bound, toU[l] - toT[l]);
+      }
+    }
+    // Leave room for rounding in the stored distances
+    return bound * (1 - 1e-9);
+  }
+};
+
+/// @brief Goal-directed `dijkstra` using landmark lower bounds (A* with the
+///        ALT heuristic). Same contract as `dijkstra`, including how
+///        `ignoreNodes` is treated.
+/// @param G graph
+/// @param landmarks landmarks computed for `G`
+/// @param start starting node ID
+/// @param target ending node ID
+/// @param ignoreNodes node IDs to skip, other than `start` and `target`
+/// @return node IDs on shortest path from `start` to `target`, or empty
+vector<long long> altSearch(const frozen_graph<long long, double>& G,
+                            const Landmarks& landmarks, long long start,
+                            long long target,
+                            const set<long long>& ignoreNodes);
+
+/// @brief Same as above on dense vertex indices.
+vector<uint32_t> altSearchByIndex(const frozen_graph<long long, double>& G,
+                                  const Landmarks& landmarks, uint32_t start,
+                                  uint32_t target,
+                                  const set<long long>& ignoreNodes);
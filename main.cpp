@@ -6,27 +6,103 @@
 #include <vector>
 
 #include "application.h"
+#include "building_matrix.h"
+#include "frozen_graph.h"
 #include "graph.h"
+#include "graph_cache.h"
+#include "parallel.h"
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
+  // Optional flags: --algorithm=dijkstra|astar|bidirectional|alt,
+  // --landmarks=N (with alt), --matrix (precomputed building-pair paths),
+  // --meeting=center|minmax|minsum, --people=N, --stats (search counters)
+  AppOptions appOptions;
+  bool useMatrix = false;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--matrix") {
+      useMatrix = true;
+      continue;
+    }
+    if (arg == "--stats") {
+      appOptions.stats = true;
+      continue;
+    }
+    string algorithmFlag = "--algorithm=";
+    string landmarksFlag = "--landmarks=";
+    string meetingFlag = "--meeting=";
+    string peopleFlag = "--people=";
+    if (arg.rfind(algorithmFlag, 0) == 0 &&
+        parseSearchAlgorithm(arg.substr(algorithmFlag.size()),
+                             appOptions.algorithm)) {
+      continue;
+    }
+    if (arg.rfind(meetingFlag, 0) == 0 &&
+        parseMeetingPoint(arg.substr(meetingFlag.size()),
+                          appOptions.meetingPoint)) {
+      continue;
+    }
+    if (arg.rfind(landmarksFlag, 0) == 0 &&
+        arg.size() > landmarksFlag.size() &&
+        arg.find_first_not_of("0123456789", landmarksFlag.size()) ==
+            string::npos) {
+      appOptions.landmarks = stoul(arg.substr(landmarksFlag.size()));
+      continue;
+    }
+    if (arg.rfind(peopleFlag, 0) == 0 && arg.size() > peopleFlag.size() &&
+        arg.find_first_not_of("0123456789", peopleFlag.size()) ==
+            string::npos) {
+      appOptions.people = stoul(arg.substr(peopleFlag.size()));
+      if (appOptions.people > 0) {
+        continue;
+      }
+    }
+    cerr << "Unknown argument: " << arg << endl;
+    return 1;
+  }
+
   cout << "** Navigating UIC open street map **" << endl;
   cout << std::setprecision(8);
 
   string default_filename = "data/uic-fa24.osm.json";
 
-  // Build graph from input data
-  graph<long long, double> G;
+  string cache_filename = default_filename + ".bin";
+
+  // Load the binary cache if it matches the input data; otherwise build the
+  // graph from JSON, keep only the read-only snapshot, and refresh the cache
+  frozen_graph<long long, double> G;
   vector<BuildingInfo> buildings;
-  ifstream input(default_filename);
-  buildGraph(input, G, buildings);
+  vector<Coordinates> coords;
+  if (!loadGraphCache(cache_filename, default_filename, G, buildings,
+                      coords)) {
+    graph<long long, double, flat_hash_storage> mutableGraph;
+    id_interner<long long> ids;
+    ifstream input(default_filename);
+    BuildOptions options;
+    options.threads = defaultThreadCount();
+    buildGraphStreaming(input, mutableGraph, buildings, ids, coords, options);
+    G = frozen_graph<long long, double>(mutableGraph, ids);
+    writeGraphCache(cache_filename, default_filename, G, buildings, coords);
+  }
 
   cout << "# of buildings: " << buildings.size() << endl;
 
   cout << "# of vertices: " << G.numVertices() << endl;
   cout << "# of edges: " << G.numEdges() << endl;
-  application(buildings, G);
+
+  // The building table is keyed to this exact graph, so it lives next to
+  // the map and is recomputed whenever the graph changes
+  BuildingMatrix matrix;
+  if (useMatrix) {
+    string matrix_filename = default_filename + ".matrix";
+    if (!loadBuildingMatrix(matrix_filename, G, buildings, matrix)) {
+      matrix = BuildingMatrix(G, buildings, defaultThreadCount());
+      writeBuildingMatrix(matrix_filename, G, buildings, matrix);
+    }
+  }
+  application(buildings, G, VertexCoordinates(G, coords), matrix, appOptions);
 
   cout << "** Done **" << endl;
   return 0;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/// @brief Split `[0, n)` into at most `threads` contiguous chunks and run
+///        `fn(begin, end)` on each chunk in its own thread, returning once all
+///        chunks are done. With `threads <= 1` (or tiny `n`) everything runs on
+///        the calling thread. `fn` must only write to state owned by its chunk.
+/// @param n number of work items
+/// @param threads maximum number of threads to use
+/// @param fn callable taking `(size_t begin, size_t end)`
+template <typename Fn>
+void parallelFor(size_t n, unsigned threads, Fn&& fn) {
+  size_t workers = min<size_t>(max(threads, 1u), n);
+  if (workers <= 1) {
+    if (n) {
+      fn(size_t(0), n);
+    }
+    return;
+  }
+
+  vector<thread> pool;
+  pool.reserve(workers - 1);
+  size_t chunk = (n + workers - 1) / workers;
+  for (size_t begin = chunk; begin < n; begin += chunk) {
+    pool.emplace_back(fn, begin, min(n, begin + chunk));
+  }
+  fn(size_t(0), min(n, chunk));
+  for (thread& t : pool) {
+    t.join();
+  }
+}
+
+/// @brief Number of worker threads to use when the caller asks for "all of
+///        them": the hardware concurrency, or 1 if it is unknown.
+inline unsigned defaultThreadCount() {
+  return max(thread::hardware_concurrency(), 1u);
+}
@@ -0,0 +1,121 @@
+#include "route_cache.h"
+
+#include <algorithm>
+
+#include "application.h"
+
+using namespace std;
+
+namespace {
+
+// splitmix64 finalizer: cheap, and every input bit affects every output bit
+uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+RouteCache::RouteCache(size_t capacity) : capacity(max<size_t>(capacity, 1)) {
+  index.reserve(this->capacity);
+}
+
+size_t RouteCache::KeyHash::operator()(const Key& key) const {
+  uint64_t h = mix(static_cast<uint64_t>(key.start));
+  h = mix(h ^ static_cast<uint64_t>(key.target));
+  return mix(h ^ key.ignoreHash);
+}
+
+RouteCache::Key RouteCache::makeKey(long long start, long long target,
+                                    const set<long long>& ignoreNodes) {
+  // The set iterates in sorted order, so equal sets hash equally
+  uint64_t h = mix(ignoreNodes.size());
+  for (long long v : ignoreNodes) {
+    h = mix(h ^ static_cast<uint64_t>(v));
+  }
+  return {start, target, h};
+}
+
+bool RouteCache::lookup(uint64_t version, const Key& key, Route& out) {
+  lock_guard<mutex> lock(m);
+  if (version != graphVersion) {
+    entries.clear();
+    index.clear();
+    graphVersion = version;
+  }
+  auto it = index.find(key);
+  if (it == index.end()) {
+    missCount++;
+    return false;
+  }
+  entries.splice(entries.begin(), entries, it->second);
+  out = it->second->second;
+  hitCount++;
+  return true;
+}
+
+void RouteCache::insert(uint64_t version, const Key& key, const Route& value) {
+  lock_guard<mutex> lock(m);
+  // The graph changed while we searched, or another thread got here first
+  if (version != graphVersion || index.count(key)) {
+    return;
+  }
+  if (entries.size() >= capacity) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+  }
+  entries.emplace_front(key, value);
+  index.emplace(key, entries.begin());
+}
+
+template <typename GraphT>
+RouteCache::Route RouteCache::routeImpl(const GraphT& G, long long start,
+                                        long long target,
+                                        const set<long long>& ignoreNodes) {
+  uint64_t version = G.version();
+  Key key = makeKey(start, target, ignoreNodes);
+  Route result;
+  if (lookup(version, key, result)) {
+    return result;
+  }
+
+  result.path = dijkstra(G, start, target, ignoreNodes);
+  result.length = result.path.empty() ? -1 : pathLength(G, result.path);
+  insert(version, key, result);
+  return result;
+}
+
+RouteCache::Route RouteCache::route(const graph<long long, double>& G,
+                                    long long start, long long target,
+                                    const set<long long>& ignoreNodes) {
+  return routeImpl(G, start, target, ignoreNodes);
+}
+
+RouteCache::Route RouteCache::route(const frozen_graph<long long, double>& G,
+                                    long long start, long long target,
+                                    const set<long long>& ignoreNodes) {
+  return routeImpl(G, start, target, ignoreNodes);
+}
+
+size_t RouteCache::hits() const {
+  lock_guard<mutex> lock(m);
+  return hitCount;
+}
+
+size_t RouteCache::misses() const {
+  lock_guard<mutex> lock(m);
+  return missCount;
+}
+
+size_t RouteCache::size() const {
+  lock_guard<mutex> lock(m);
+  return entries.size();
+}
+
+void RouteCache::clear() {
+  lock_guard<mutex> lock(m);
+  entries.clear();
+  index.clear();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "frozen_graph.h"
+#include "graph.h"
+
+using namespace std;
+
+/// @brief Bounded least-recently-used cache of `dijkstra` results, keyed by
+///        start, target and a 64-bit hash of the ignore set. A repeated
+///        query costs one hash of the ignore set plus a table lookup.
+///
+///        Entries belong to one graph version (see `graph::version`): a
+///        query on a graph that changed, or on a different graph, drops
+///        everything first. Safe to share between threads; searches for
+///        misses run outside the lock.
+class RouteCache {
+ public:
+  /// A cached answer: the path, and its length or -1 if there is no path
+  struct Route {
+    vector<long long> path;
+    double length = -1;
+  };
+
+  /// @brief Keep at most `capacity` routes (at least 1).
+  explicit RouteCache(size_t capacity);
+
+  /// @brief `dijkstra(G, start, target, ignoreNodes)` with its length,
+  ///        answered from the cache when possible.
+  Route route(const graph<long long, double>& G, long long start,
+              long long target, const set<long long>& ignoreNodes);
+  Route route(const frozen_graph<long long, double>& G, long long start,
+              long long target, const set<long long>& ignoreNodes);
+
+  /// Lookups answered from the cache / that had to search
+  size_t hits() const;
+  size_t misses() const;
+
+  /// Number of cached routes
+  size_t size() const;
+
+  /// @brief Drop every entry. The hit and miss counters are kept.
+  void clear();
+
+ private:
+  struct Key {
+    long long start;
+    long long target;
+    uint64_t ignoreHash;
+
+    bool operator==(const Key& other) const {
+      return start == other.start && target == other.target &&
+             ignoreHash == other.ignoreHash;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  using Entry = pair<Key, Route>;
+
+  size_t capacity;
+  mutable mutex m;
+  list<Entry> entries;  // most recently used first
+  unordered_map<Key, list<Entry>::iterator, KeyHash> index;
+  uint64_t graphVersion = 0;
+  size_t hitCount = 0;
+  size_t missCount = 0;
+
+  static Key makeKey(long long start, long long target,
+                     const set<long long>& ignoreNodes);
+
+  /// Cached route for `key` under `version`, counting the hit or miss
+  bool lookup(uint64_t version, const Key& key, Route& out);
+
+  /// Store a route computed for `version`, evicting the oldest if full
+  void insert(uint64_t version, const Key& key, const Route& value);
+
+  template <typename GraphT>
+  Route routeImpl(const GraphT& G, long long start, long long target,
+                  const set<long long>& ignoreNodes);
+};
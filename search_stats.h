@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+using namespace std;
+
+/// @brief Counters describing how much work searches did. Pass one to a
+///        search overload that takes it; each search adds to the counts
+///        (and keeps the largest heap seen), so one instance can total a
+///        group of searches. Start from `SearchStats()` to measure one.
+struct SearchStats {
+  static constexpr bool enabled = true;
+
+  size_t settled = 0;      // vertices whose distance became final
+  size_t relaxed = 0;      // edges whose tentative distance was computed
+  size_t pushes = 0;       // heap inserts and decrease-keys
+  size_t pops = 0;         // heap pops, including stale ones
+  size_t stalePops = 0;    // pops of entries already superseded
+  size_t maxHeapSize = 0;  // largest heap size seen
+  double milliseconds = 0;  // wall time spent searching
+
+  void start() {
+    startedAt = chrono::steady_clock::now();
+  }
+  void stop() {
+    chrono::duration<double, milli> elapsed =
+        chrono::steady_clock::now() - startedAt;
+    milliseconds += elapsed.count();
+  }
+  void onPop() {
+    pops++;
+  }
+  void onStalePop() {
+    stalePops++;
+  }
+  void onSettle() {
+    settled++;
+  }
+  void onRelax() {
+    relaxed++;
+  }
+  void onPush(size_t heapSize) {
+    pushes++;
+    maxHeapSize = max(maxHeapSize, heapSize);
+  }
+
+ private:
+  chrono::steady_clock::time_point startedAt;
+};
+
+/// @brief Stand-in for `SearchStats` when nobody asked for them: every
+///        hook is an empty inline function, so an uninstrumented search
+///        compiles to the same loop as before.
+struct NoStats {
+  static constexpr bool enabled = false;
+
+  void start() {
+  }
+  void stop() {
+  }
+  void onPop() {
+  }
+  void onStalePop() {
+  }
+  void onSettle() {
+  }
+  void onRelax() {
+  }
+  void onPush(size_t) {
+  }
+};
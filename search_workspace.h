@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "indexed_heap.h"
+
+using namespace std;
+
+/// @brief Per-vertex search state (distance, predecessor, ignored and settled
+///        flags) plus a priority queue, reused across queries. Each entry is
+///        stamped with the epoch it was last written in, and `reset` just
+///        advances the epoch, so stale entries from earlier queries read as
+///        unvisited without touching them. A query then costs time
+///        proportional to the part of the graph it explores rather than to
+///        the graph's size.
+///
+///        One workspace serves one search at a time; give each thread its
+///        own.
+class SearchWorkspace {
+ public:
+  static constexpr double INF = numeric_limits<double>::max();
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  SearchWorkspace() = default;
+
+  /// @brief Workspace sized for graphs of up to `n` vertices.
+  explicit SearchWorkspace(size_t n) {
+    reset(n);
+  }
+
+  /// @brief Start a new query over a graph with `n` vertices. O(1) unless the
+  ///        workspace has to grow, or once every 2^32 queries when the epoch
+  ///        counter wraps around.
+  void reset(size_t n) {
+    if (stamps.size() < n) {
+      distances.resize(n);
+      predecessors.resize(n);
+      stamps.resize(n, 0);
+      ignoredStamps.resize(n, 0);
+      settledStamps.resize(n, 0);
+      queue.reserve(n);
+    }
+    queue.clear();
+    if (++epoch == 0) {
+      fill(stamps.begin(), stamps.end(), 0);
+      fill(ignoredStamps.begin(), ignoredStamps.end(), 0);
+      fill(settledStamps.begin(), settledStamps.end(), 0);
+      epoch = 1;
+    }
+  }
+
+  /// @brief Best known distance to `v` in this query, or `INF`.
+  double distance(uint32_t v) const {
+    return stamps[v] == epoch ? distances[v] : INF;
+  }
+
+  /// @brief Predecessor of `v` on its best known path, or `NONE`.
+  uint32_t predecessor(uint32_t v) const {
+    return stamps[v] == epoch ? predecessors[v] : NONE;
+  }
+
+  /// @brief Record a path of length `d` to `v` through `pred`.
+  void update(uint32_t v, double d, uint32_t pred) {
+    stamps[v] = epoch;
+    distances[v] = d;
+    predecessors[v] = pred;
+  }
+
+  /// @brief Record a path of length `d` to `v` without its predecessor,
+  ///        for searches that never unpack paths.
+  void setDistance(uint32_t v, double d) {
+    stamps[v] = epoch;
+    distances[v] = d;
+  }
+
+  /// @brief Whether `v` was excluded from this query.
+  bool ignored(uint32_t v) const {
+    return ignoredStamps[v] == epoch;
+  }
+
+  /// @brief Exclude `v` from this query, or include it again.
+  void setIgnored(uint32_t v, bool value) {
+    ignoredStamps[v] = value ? epoch : 0;
+  }
+
+  /// @brief Whether `v`'s distance is final in this query.
+  bool settled(uint32_t v) const {
+    return settledStamps[v] == epoch;
+  }
+
+  /// @brief Mark `v`'s distance as final.
+  void settle(uint32_t v) {
+    settledStamps[v] = epoch;
+  }
+
+  /// @brief Priority queue for this query, emptied by `reset`.
+  indexed_heap<double>& heap() {
+    return queue;
+  }
+
+  /// @brief Number of vertices the workspace currently has room for.
+  size_t capacity() const {
+    return stamps.size();
+  }
+
+ private:
+  vector<double> distances;
+  vector<uint32_t> predecessors;
+  vector<uint32_t> stamps;
+  vector<uint32_t> ignoredStamps;
+  vector<uint32_t> settledStamps;
+  indexed_heap<double> queue;
+  uint32_t epoch = 0;
+};
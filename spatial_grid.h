@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dist.h"
+
+using namespace std;
+
+/// @brief Uniform lat/lon bucket grid for fixed-radius neighbor queries.
+///        Cells are sized so that every point within `radius` miles of a
+///        query lies in the query's cell or one of its 8 neighbors; callers
+///        still apply the exact distance test to the candidates.
+///
+///        The cell width in longitude depends on the highest latitude the
+///        grid will see. If that is too close to a pole, or points sit near
+///        the antimeridian where cells would wrap, `usable()` is false and
+///        callers should fall back to a linear scan.
+/// @tparam IdT point identifier type
+template <typename IdT>
+class spatial_grid {
+ private:
+  double cellLat;  // degrees per cell
+  double cellLon;
+  double maxAbsLat;
+  bool valid;
+  unordered_map<uint64_t, vector<pair<IdT, Coordinates>>> cells;
+
+  int64_t row(double lat) const {
+    return (int64_t)floor(lat / cellLat);
+  }
+
+  int64_t col(double lon) const {
+    return (int64_t)floor(lon / cellLon);
+  }
+
+  static uint64_t key(int64_t r, int64_t c) {
+    return ((uint64_t)r << 32) ^ (uint32_t)c;
+  }
+
+ public:
+  /// @brief Empty grid for queries of `radius` miles among points whose
+  ///        latitudes are all within `maxAbsLat` degrees of the equator.
+  spatial_grid(double radius, double maxAbsLat) : maxAbsLat(maxAbsLat) {
+    const double PI = 3.14159265;
+    const double EARTH_RADIUS = 3963.1;  // miles, as in distBetween2Points
+    // Pad for rounding in distBetween2Points, which loses precision on
+    // short distances
+    const double MARGIN = 1.05;
+
+    double angle = radius * MARGIN / EARTH_RADIUS;  // radians
+    double cosLat = cos(maxAbsLat * PI / 180.0);
+    valid = maxAbsLat <= 90 && cosLat > 0 && sin(angle / 2) < cosLat;
+
+    // hav(d) >= cos(lat1) cos(lat2) hav(dlon), so
+    // |dlon| <= 2 asin(sin(d / 2) / cos(maxLat)); and |dlat| <= d
+    cellLat = angle * 180.0 / PI;
+    cellLon = valid ? 2 * asin(sin(angle / 2) / cosLat) * 180.0 / PI : 360;
+    valid = valid && cellLat > 0 && cellLon < 90;
+  }
+
+  /// @brief Whether the grid can answer queries exactly (see class comment).
+  bool usable() const {
+    return valid;
+  }
+
+  /// @brief Whether `forEachCandidate(c, ...)` is guaranteed to report every
+  ///        point within `radius` of `c`.
+  bool covers(Coordinates c) const {
+    return valid && fabs(c.lat) <= maxAbsLat && fabs(c.lon) + cellLon < 180;
+  }
+
+  /// @brief Add a point. Points within one cell of the antimeridian make the
+  ///        grid unusable, since their neighbors would wrap around.
+  void insert(const IdT& id, Coordinates location) {
+    if (fabs(location.lon) + cellLon >= 180) {
+      valid = false;
+    }
+    if (!valid) {
+      return;
+    }
+    cells[key(row(location.lat), col(location.lon))].emplace_back(id,
+                                                                  location);
+  }
+
+  /// @brief Call `fn(id, location)` for every point in the 3x3 block of
+  ///        cells around `c`; a superset of the points within `radius`.
+  template <typename Fn>
+  void forEachCandidate(Coordinates c, Fn&& fn) const {
+    int64_t r = row(c.lat);
+    int64_t q = col(c.lon);
+    for (int64_t dr = -1; dr <= 1; dr++) {
+      for (int64_t dq = -1; dq <= 1; dq++) {
+        auto it = cells.find(key(r + dr, q + dq));
+        if (it == cells.end()) {
+          continue;
+        }
+        for (const auto& [id, location] : it->second) {
+          fn(id, location);
+        }
+      }
+    }
+  }
+};
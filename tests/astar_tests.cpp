@@ -0,0 +1,91 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <set>
+#include <vector>
+
+#include "application.h"
+#include "astar.h"
+#include "frozen_graph.h"
+#include "graph.h"
+
+using namespace std;
+using namespace testing;
+
+struct UicMap {
+  frozen_graph<long long, double> G;
+  VertexCoordinates coords;
+  vector<BuildingInfo> buildings;
+  set<long long> buildingNodes;
+};
+
+// Loaded once; parsing the full map is slow under the sanitizers
+static const UicMap& uicMap() {
+  static UicMap m = [] {
+    UicMap m;
+    graph<long long, double> g;
+    id_interner<long long> ids;
+    vector<Coordinates> coords;
+    ifstream input("data/uic-fa24.osm.json");
+    buildGraph(input, g, m.buildings, ids, coords);
+    m.G = frozen_graph<long long, double>(g, ids);
+    m.coords = VertexCoordinates(m.G, coords);
+    for (const auto& b : m.buildings) {
+      m.buildingNodes.insert(b.id);
+    }
+    return m;
+  }();
+  return m;
+}
+
+TEST(AStar, LowerBoundScale) {
+  const UicMap& m = uicMap();
+  ASSERT_THAT(m.coords.scale, AllOf(Gt(0.9), Le(1.0)));
+  for (uint32_t u = 0; u < m.G.numVertices(); u++) {
+    for (uint32_t e = m.G.edgeBegin(u); e < m.G.edgeEnd(u); e++) {
+      ASSERT_THAT(m.coords.lowerBound(u, m.G.edgeTarget(e)),
+                  Le(m.G.edgeWeight(e)))
+          << "Heuristic must never overestimate an edge";
+    }
+  }
+}
+
+TEST(AStar, MatchesDijkstra) {
+  const UicMap& m = uicMap();
+  ASSERT_THAT(
+      astar(m.G, m.coords, 664275388, 151672203, m.buildingNodes),
+      ElementsAreArray(dijkstra(m.G, 664275388, 151672203, m.buildingNodes)));
+
+  for (size_t i = 0; i < m.buildings.size(); i += 7) {
+    for (size_t j = 3; j < m.buildings.size(); j += 11) {
+      long long s = m.buildings[i].id;
+      long long t = m.buildings[j].id;
+      vector<long long> expected = dijkstra(m.G, s, t, m.buildingNodes);
+      vector<long long> actual = astar(m.G, m.coords, s, t, m.buildingNodes);
+      ASSERT_THAT(actual, ElementsAreArray(expected))
+          << "A* disagrees from " << s << " to " << t;
+    }
+  }
+}
+
+TEST(AStar, EdgeCases) {
+  const UicMap& m = uicMap();
+  EXPECT_THAT(astar(m.G, m.coords, 664275388, 664275388, {}),
+              ElementsAre(664275388));
+  EXPECT_THAT(astar(m.G, m.coords, 664275388, -1, {}), IsEmpty());
+
+  // Zero-length edges between coincident points must not break the bound
+  graph<long long, double> g;
+  for (long long i = 0; i < 3; i++) {
+    g.addVertex(i);
+  }
+  g.addEdge(0, 1, 0);
+  g.addEdge(1, 2, 5);
+  frozen_graph<long long, double> f(g);
+  VertexCoordinates coords(
+      f, {Coordinates(41.87, -87.65), Coordinates(41.87, -87.65),
+          Coordinates(41.88, -87.65)});
+  EXPECT_THAT(astar(f, coords, 0, 2, {}), ElementsAre(0, 1, 2));
+  EXPECT_THAT(astar(f, coords, 2, 0, {}), IsEmpty());
+}
@@ -0,0 +1,83 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "application.h"
+#include "batch_router.h"
+#include "frozen_graph.h"
+#include "graph.h"
+#include "thread_pool.h"
+
+using namespace std;
+using namespace testing;
+
+TEST(BatchRouter, ThreadPoolRunsEveryWorker) {
+  ThreadPool pool(4);
+  ASSERT_THAT(pool.size(), Eq(4u));
+
+  // Reused across jobs; each job runs exactly once per worker
+  for (int round = 0; round < 50; round++) {
+    vector<int> calls(pool.size(), 0);
+    pool.run([&](unsigned worker) { calls[worker]++; });
+    ASSERT_THAT(calls, Each(Eq(1)));
+  }
+
+  atomic<int> finished(0);
+  EXPECT_THROW(pool.run([&](unsigned worker) {
+                 if (worker == 2) {
+                   throw runtime_error("worker failed");
+                 }
+                 finished++;
+               }),
+               runtime_error);
+  EXPECT_THAT(finished.load(), Eq(3));
+
+  // Still usable after a job threw
+  atomic<int> after(0);
+  pool.run([&](unsigned) { after++; });
+  EXPECT_THAT(after.load(), Eq(4));
+  EXPECT_THAT(ThreadPool(0).size(), Eq(1u));
+}
+
+TEST(BatchRouter, MatchesDijkstra) {
+  graph<long long, double> g;
+  vector<BuildingInfo> buildings;
+  ifstream input("data/uic-fa24.osm.json");
+  buildGraph(input, g, buildings);
+  frozen_graph<long long, double> G(g);
+  set<long long> buildingNodes;
+  for (const auto& b : buildings) {
+    buildingNodes.insert(b.id);
+  }
+
+  vector<pair<long long, long long>> queries;
+  for (size_t i = 0; i < buildings.size(); i += 3) {
+    for (size_t j = 1; j < buildings.size(); j += 4) {
+      queries.emplace_back(buildings[i].id, buildings[j].id);
+    }
+  }
+  queries.emplace_back(664275388, -1);  // unknown target
+
+  for (unsigned threads : {1u, 4u}) {
+    BatchRouter router(G, threads);
+    ASSERT_THAT(router.threads(), Eq(threads));
+    // Twice, so the second batch reuses the workers and their workspaces
+    for (int round = 0; round < 2; round++) {
+      vector<vector<long long>> paths = router.route(queries, buildingNodes);
+      ASSERT_THAT(paths, SizeIs(queries.size()));
+      for (size_t i = 0; i < queries.size(); i++) {
+        auto [s, t] = queries[i];
+        ASSERT_THAT(paths[i],
+                    ElementsAreArray(dijkstra(g, s, t, buildingNodes)))
+            << "Batch disagrees from " << s << " to " << t;
+      }
+    }
+    EXPECT_THAT(router.route({}, buildingNodes), IsEmpty());
+  }
+}
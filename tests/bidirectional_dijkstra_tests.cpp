@@ -0,0 +1,121 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <set>
+#include <vector>
+
+#include "application.h"
+#include "bidirectional_dijkstra.h"
+#include "frozen_graph.h"
+#include "graph.h"
+
+using namespace std;
+using namespace testing;
+
+struct BidirectionalUicMap {
+  frozen_graph<long long, double> G;
+  vector<BuildingInfo> buildings;
+  set<long long> buildingNodes;
+};
+
+static const BidirectionalUicMap& uicMap() {
+  static BidirectionalUicMap m = [] {
+    BidirectionalUicMap m;
+    graph<long long, double> g;
+    ifstream input("data/uic-fa24.osm.json");
+    buildGraph(input, g, m.buildings);
+    m.G = frozen_graph<long long, double>(g);
+    for (const auto& b : m.buildings) {
+      m.buildingNodes.insert(b.id);
+    }
+    return m;
+  }();
+  return m;
+}
+
+TEST(Bidirectional, ReverseEdges) {
+  graph<long long, double> g;
+  for (long long i = 0; i < 4; i++) {
+    g.addVertex(i);
+  }
+  g.addEdge(0, 1, 1);
+  g.addEdge(2, 1, 2);
+  g.addEdge(1, 3, 3);
+  g.addEdge(3, 1, 4);
+  frozen_graph<long long, double> f(g);
+
+  uint32_t one = f.indexOf(1);
+  vector<pair<long long, double>> in;
+  for (uint32_t e = f.inEdgeBegin(one); e < f.inEdgeEnd(one); e++) {
+    in.emplace_back(f.vertexAt(f.inEdgeSource(e)), f.inEdgeWeight(e));
+  }
+  ASSERT_THAT(in, ElementsAre(Pair(0, 1), Pair(2, 2), Pair(3, 4)));
+  ASSERT_THAT(f.inEdgeEnd(f.indexOf(0)) - f.inEdgeBegin(f.indexOf(0)), Eq(0));
+}
+
+TEST(Bidirectional, SmallGraphs) {
+  graph<long long, double> g;
+  for (long long i = 0; i < 8; i++) {
+    g.addVertex(i);
+  }
+  g.addEdge(0, 1, 2.0);
+  g.addEdge(0, 2, 1.0);
+  g.addEdge(0, 3, 4.0);
+  g.addEdge(1, 5, 2.0);
+  g.addEdge(1, 4, 8.0);
+  g.addEdge(1, 2, 5.0);
+  g.addEdge(2, 0, 9.0);
+  g.addEdge(2, 4, 11.0);
+  g.addEdge(3, 2, 2.0);
+  g.addEdge(4, 7, 3.0);
+  g.addEdge(5, 6, 3.0);
+  g.addEdge(6, 7, 1.0);
+  g.addEdge(7, 5, 2.0);
+  g.addEdge(7, 4, 1.0);
+  frozen_graph<long long, double> f(g);
+
+  EXPECT_THAT(bidirectionalDijkstra(f, 0, 4, {}),
+              ElementsAre(0, 1, 5, 6, 7, 4));
+  EXPECT_THAT(bidirectionalDijkstra(f, 0, 0, {}), ElementsAre(0));
+  EXPECT_THAT(bidirectionalDijkstra(f, 4, 0, {}), IsEmpty());
+  EXPECT_THAT(bidirectionalDijkstra(f, 0, 4, {0, 4, 5}),
+              ElementsAre(0, 1, 4))
+      << "Ignored nodes should be skipped except for start and target";
+  EXPECT_THAT(bidirectionalDijkstra(f, 0, 42, {}), IsEmpty());
+}
+
+TEST(Bidirectional, MatchesDijkstra) {
+  const BidirectionalUicMap& m = uicMap();
+  for (size_t i = 0; i < m.buildings.size(); i += 7) {
+    for (size_t j = 3; j < m.buildings.size(); j += 11) {
+      long long s = m.buildings[i].id;
+      long long t = m.buildings[j].id;
+      vector<long long> expected = dijkstra(m.G, s, t, m.buildingNodes);
+      vector<long long> actual =
+          bidirectionalDijkstra(m.G, s, t, m.buildingNodes);
+      ASSERT_THAT(actual, ElementsAreArray(expected))
+          << "Bidirectional disagrees from " << s << " to " << t;
+    }
+  }
+}
+
+TEST(Bidirectional, FindPathSelectsAlgorithm) {
+  const BidirectionalUicMap& m = uicMap();
+  SearchAlgorithm algorithm;
+  ASSERT_THAT(parseSearchAlgorithm("bidirectional", algorithm), IsTrue());
+  ASSERT_THAT(algorithm, Eq(SearchAlgorithm::Bidirectional));
+  ASSERT_THAT(parseSearchAlgorithm("bogus", algorithm), IsFalse());
+
+  uint32_t arc = m.G.indexOf(664275388);
+  uint32_t lcb = m.G.indexOf(151672203);
+  vector<uint32_t> expected = dijkstraByIndex(m.G, arc, lcb, m.buildingNodes);
+  for (SearchAlgorithm a : {SearchAlgorithm::Dijkstra, SearchAlgorithm::AStar,
+                            SearchAlgorithm::Bidirectional,
+                            SearchAlgorithm::ALT}) {
+    // No coordinates or landmarks: A* and ALT fall back to Dijkstra
+    EXPECT_THAT(findPath(m.G, VertexCoordinates(), Landmarks(), arc, lcb,
+                         m.buildingNodes, a),
+                ElementsAreArray(expected));
+  }
+}
@@ -5,12 +5,14 @@
 #include <iostream>
 #include <map>
 #include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "application.h"
 #include "dist.h"
 #include "graph.h"
+#include "spatial_grid.h"
 
 using namespace std;
 using namespace testing;
@@ -115,3 +117,196 @@ TEST(BuildGraph, Full) {
   ASSERT_THAT(g.getWeight(11757616193, 10930768586, weight), IsTrue());
   ASSERT_THAT(weight, DoubleNear(0.010135770596645196, 1e-6));
 }
+
+TEST(BuildGraph, InternsVertices) {
+  graph<long long, double> g;
+  vector<BuildingInfo> buildings;
+  id_interner<long long> ids;
+  ifstream input("data/small_buildings.json");
+  buildGraph(input, g, buildings, ids);
+
+  ASSERT_THAT(ids.size(), Eq(g.numVertices()));
+  // Buildings first, then waypoints, in input order
+  ASSERT_THAT(ids.values(), ElementsAre(1, 2, 3, 4));
+  for (long long v : g.getVertices()) {
+    ASSERT_THAT(ids.at(ids.find(v)), Eq(v));
+  }
+}
+
+TEST(BuildGraph, FlatStorageMatches) {
+  graph<long long, double> g;
+  graph<long long, double, flat_hash_storage> flat;
+  vector<BuildingInfo> buildings, flatBuildings;
+  id_interner<long long> ids, flatIds;
+  ifstream input("data/uic-fa24.osm.json");
+  buildGraph(input, g, buildings, ids);
+  ifstream flatInput("data/uic-fa24.osm.json");
+  buildGraph(flatInput, flat, flatBuildings, flatIds);
+
+  ASSERT_THAT(flat.numVertices(), Eq(g.numVertices()));
+  ASSERT_THAT(flat.numEdges(), Eq(g.numEdges()));
+  ASSERT_THAT(flatBuildings, ElementsAreArray(buildings));
+  ASSERT_THAT(flatIds.values(), ElementsAreArray(ids.values()));
+
+  double expected, actual;
+  for (long long v : g.getVertices()) {
+    for (long long n : g.neighbors(v)) {
+      g.getWeight(v, n, expected);
+      ASSERT_THAT(flat.getWeight(v, n, actual), IsTrue());
+      ASSERT_THAT(actual, Eq(expected));
+    }
+  }
+}
+
+void expectSameGraph(graph<long long, double>& expected,
+                     graph<long long, double>& actual) {
+  ASSERT_THAT(actual.numVertices(), Eq(expected.numVertices()));
+  ASSERT_THAT(actual.numEdges(), Eq(expected.numEdges()));
+  ASSERT_THAT(actual.getVertices(),
+              UnorderedElementsAreArray(expected.getVertices()));
+  double expectedWeight, actualWeight;
+  for (long long v : expected.getVertices()) {
+    ASSERT_THAT(actual.neighbors(v), ElementsAreArray(expected.neighbors(v)));
+    for (long long n : expected.neighbors(v)) {
+      expected.getWeight(v, n, expectedWeight);
+      actual.getWeight(v, n, actualWeight);
+      ASSERT_THAT(actualWeight, Eq(expectedWeight));
+    }
+  }
+}
+
+TEST(BuildGraph, StreamingMatchesDom) {
+  for (string filename : {"data/empty.json", "data/line.json",
+                          "data/small_buildings.json",
+                          "data/uic-fa24.osm.json"}) {
+    SCOPED_TRACE(filename);
+    graph<long long, double> dom, streamed;
+    vector<BuildingInfo> domBuildings, streamedBuildings;
+    id_interner<long long> domIds, streamedIds;
+    vector<Coordinates> domCoords, streamedCoords;
+
+    ifstream domInput(filename);
+    buildGraph(domInput, dom, domBuildings, domIds, domCoords);
+    ifstream streamedInput(filename);
+    ASSERT_THAT(buildGraphStreaming(streamedInput, streamed, streamedBuildings,
+                                    streamedIds, streamedCoords),
+                IsTrue());
+
+    expectSameGraph(dom, streamed);
+    if (HasFatalFailure()) return;
+    ASSERT_THAT(streamedBuildings, ElementsAreArray(domBuildings));
+    ASSERT_THAT(streamedIds.values(), ElementsAreArray(domIds.values()));
+    ASSERT_THAT(streamedCoords.size(), Eq(domCoords.size()));
+    for (size_t i = 0; i < domCoords.size(); i++) {
+      ASSERT_THAT(streamedCoords[i].lat, Eq(domCoords[i].lat));
+      ASSERT_THAT(streamedCoords[i].lon, Eq(domCoords[i].lon));
+    }
+  }
+}
+
+TEST(BuildGraph, StreamingFootwaysFirst) {
+  // Footways may precede the waypoints they reference
+  string json = R"({
+    "footways": [[3, 4]],
+    "extra": {"ignored": [1, 2, {"id": 99}]},
+    "buildings": [{"id": 1, "lat": 41.8720714, "lon": -87.6492469,
+                   "abbr": "NSQ", "name": "North Side of Quad"}],
+    "waypoints": [{"id": 3, "lat": 41.871903, "lon": -87.648950},
+                  {"id": 4, "lat": 41.871909, "lon": -87.648435}]
+  })";
+  graph<long long, double> g;
+  vector<BuildingInfo> buildings;
+  istringstream input(json);
+  ASSERT_THAT(buildGraphStreaming(input, g, buildings), IsTrue());
+
+  ASSERT_THAT(g.numVertices(), Eq(3));
+  ASSERT_THAT(buildings, SizeIs(1));
+  double weight;
+  ASSERT_THAT(g.getWeight(3, 4, weight), IsTrue());
+  EXPECT_THAT(weight, DoubleNear(0.0265, 1e-3));
+  ASSERT_THAT(g.getWeight(4, 3, weight), IsTrue());
+  ASSERT_THAT(g.getWeight(1, 3, weight), IsTrue())
+      << "Buildings should be linked once all waypoints are known";
+  EXPECT_THAT(weight, DoubleNear(0.0192231, 1e-6));
+}
+
+TEST(BuildGraph, StreamingParseError) {
+  graph<long long, double> g;
+  vector<BuildingInfo> buildings;
+  istringstream input(R"({"buildings": [)");
+  ASSERT_THAT(buildGraphStreaming(input, g, buildings), IsFalse());
+}
+
+TEST(BuildGraph, SpatialGridFindsAllNearby) {
+  // Dense clusters of points around Chicago and far north, where longitude
+  // degrees are much shorter
+  for (Coordinates center : {Coordinates(41.87, -87.65), Coordinates(69.5, 18.9),
+                             Coordinates(-33.9, 151.2)}) {
+    vector<Coordinates> points;
+    unsigned seed = 12345;
+    auto next = [&]() {
+      seed = seed * 1103515245 + 12345;
+      return (seed >> 8) % 10000 / 10000.0 - 0.5;
+    };
+    for (int i = 0; i < 2000; i++) {
+      points.emplace_back(center.lat + 0.01 * next(), center.lon + 0.02 * next());
+    }
+
+    double maxAbsLat = 0;
+    for (const auto& p : points) {
+      maxAbsLat = max(maxAbsLat, fabs(p.lat));
+    }
+    spatial_grid<int> grid(0.036, maxAbsLat);
+    for (int i = 0; i < (int)points.size(); i++) {
+      grid.insert(i, points[i]);
+    }
+    ASSERT_THAT(grid.usable(), IsTrue());
+
+    for (int q = 0; q < 200; q++) {
+      Coordinates query = points[q];
+      ASSERT_THAT(grid.covers(query), IsTrue());
+      set<int> candidates;
+      grid.forEachCandidate(query, [&](int id, Coordinates) { candidates.insert(id); });
+      for (int i = 0; i < (int)points.size(); i++) {
+        if (distBetween2Points(query, points[i]) <= 0.036) {
+          ASSERT_THAT(candidates.count(i), Eq(1))
+              << "Grid missed a point within the radius";
+        }
+      }
+      ASSERT_THAT(candidates.size(), Lt(points.size()))
+          << "Grid should prune distant points";
+    }
+  }
+
+  spatial_grid<int> polar(0.036, 90);
+  EXPECT_THAT(polar.usable(), IsFalse());
+  spatial_grid<int> antimeridian(0.036, 10);
+  antimeridian.insert(0, Coordinates(0, 179.99999));
+  EXPECT_THAT(antimeridian.usable(), IsFalse());
+}
+
+TEST(BuildGraph, ParallelMatchesSerial) {
+  graph<long long, double> serial, parallel, streamed;
+  vector<BuildingInfo> serialBuildings, parallelBuildings, streamedBuildings;
+  id_interner<long long> serialIds, parallelIds, streamedIds;
+  vector<Coordinates> serialCoords, parallelCoords, streamedCoords;
+  BuildOptions options;
+  options.threads = 4;
+
+  ifstream serialInput("data/uic-fa24.osm.json");
+  buildGraph(serialInput, serial, serialBuildings, serialIds, serialCoords);
+  ifstream parallelInput("data/uic-fa24.osm.json");
+  buildGraph(parallelInput, parallel, parallelBuildings, parallelIds,
+             parallelCoords, options);
+  ifstream streamedInput("data/uic-fa24.osm.json");
+  ASSERT_THAT(buildGraphStreaming(streamedInput, streamed, streamedBuildings,
+                                  streamedIds, streamedCoords, options),
+              IsTrue());
+
+  expectSameGraph(serial, parallel);
+  if (HasFatalFailure()) return;
+  expectSameGraph(serial, streamed);
+  if (HasFatalFailure()) return;
+  ASSERT_THAT(parallelBuildings, ElementsAreArray(serialBuildings));
+  ASSERT_THAT(parallelIds.values(), ElementsAreArray(serialIds.values()));
+}
@@ -0,0 +1,82 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <vector>
+
+#include "application.h"
+#include "building_matrix.h"
+#include "frozen_graph.h"
+#include "graph.h"
+
+using namespace std;
+using namespace testing;
+
+TEST(BuildingMatrix, MatchesSearch) {
+  graph<long long, double> g;
+  vector<BuildingInfo> buildings;
+  ifstream input("data/uic-fa24.osm.json");
+  buildGraph(input, g, buildings);
+  frozen_graph<long long, double> G(g);
+  set<long long> buildingNodes;
+  for (const auto& b : buildings) {
+    buildingNodes.insert(b.id);
+  }
+
+  BuildingMatrix matrix(G, buildings, 4);
+  ASSERT_THAT(matrix.covers(G.numVertices(), buildings.size()), IsTrue());
+  ASSERT_THAT(matrix.numBuildings(), Eq(buildings.size()));
+
+  // Serial and parallel tables agree exactly
+  BuildingMatrix serial(G, buildings);
+  EXPECT_THAT(serial.distanceTable(),
+              ElementsAreArray(matrix.distanceTable()));
+  EXPECT_THAT(serial.nextHopTable(), ElementsAreArray(matrix.nextHopTable()));
+
+  SearchWorkspace workspace;
+  for (uint32_t to = 0; to < buildings.size(); to += 3) {
+    uint32_t root = G.indexOf(buildings[to].id);
+    vector<uint32_t> sources;
+    for (const auto& b : buildings) {
+      sources.push_back(G.indexOf(b.id));
+    }
+    vector<vector<uint32_t>> expected = dijkstraOneToManyByIndex(
+        G, root, sources, buildingNodes, SearchDirection::Backward, workspace);
+
+    for (uint32_t from = 0; from < buildings.size(); from++) {
+      vector<uint32_t> path = matrix.pathTo(sources[from], to);
+      ASSERT_THAT(path, ElementsAreArray(expected[from]))
+          << "Table path from " << buildings[from].abbr << " to "
+          << buildings[to].abbr;
+      if (path.empty()) {
+        EXPECT_THAT(matrix.distance(from, to), Eq(BuildingMatrix::INF));
+      } else {
+        EXPECT_THAT(matrix.distance(from, to),
+                    DoubleNear(pathLength(G, path), 1e-9));
+      }
+    }
+  }
+
+  // From a footway node rather than a building
+  uint32_t arc = G.indexOf(664275388);
+  uint32_t lcb = find_if(buildings.begin(), buildings.end(),
+                         [](const BuildingInfo& b) {
+                           return b.id == 151672203;
+                         }) -
+                 buildings.begin();
+  uint32_t footway = G.edgeTarget(G.edgeBegin(arc));
+  vector<uint32_t> path = matrix.pathTo(footway, lcb);
+  ASSERT_THAT(path, Not(IsEmpty()));
+  EXPECT_THAT(pathLength(G, path),
+              DoubleNear(pathLength(G, dijkstraByIndex(G, footway,
+                                                       G.indexOf(151672203),
+                                                       buildingNodes)),
+                         1e-12));
+
+  EXPECT_THAT(matrix.pathTo(G.numVertices(), 0), IsEmpty());
+  EXPECT_THAT(matrix.pathTo(0, buildings.size()), IsEmpty());
+  EXPECT_THAT(BuildingMatrix().covers(G.numVertices(), buildings.size()),
+              IsFalse());
+}
@@ -0,0 +1,122 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "application.h"
+#include "contraction_hierarchy.h"
+#include "frozen_graph.h"
+#include "graph.h"
+
+using namespace std;
+using namespace testing;
+
+struct ContractedUicMap {
+  frozen_graph<long long, double> G;
+  vector<BuildingInfo> buildings;
+  set<long long> buildingNodes;
+  ContractionHierarchy ch;
+};
+
+// Loaded and contracted once; both are slow under the sanitizers
+static const ContractedUicMap& contractedUicMap() {
+  static ContractedUicMap m = [] {
+    ContractedUicMap m;
+    graph<long long, double> g;
+    ifstream input("data/uic-fa24.osm.json");
+    buildGraph(input, g, m.buildings);
+    m.G = frozen_graph<long long, double>(g);
+    for (const auto& b : m.buildings) {
+      m.buildingNodes.insert(b.id);
+    }
+    m.ch = ContractionHierarchy(m.G, m.buildingNodes);
+    return m;
+  }();
+  return m;
+}
+
+TEST(ContractionHierarchy, SmallGraph) {
+  // 0 -> 1 -> 2 -> 3 is the only way across; 4 is a dead end off 1
+  graph<long long, double> g;
+  for (long long i = 0; i < 5; i++) {
+    g.addVertex(i);
+  }
+  g.addEdge(0, 1, 1);
+  g.addEdge(1, 2, 1);
+  g.addEdge(2, 3, 1);
+  g.addEdge(1, 4, 1);
+  g.addEdge(4, 1, 1);
+  ContractionHierarchy ch(g, {});
+
+  EXPECT_THAT(ch.query(0, 3), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(ch.query(4, 3), ElementsAre(4, 1, 2, 3));
+  EXPECT_THAT(ch.query(0, 4), ElementsAre(0, 1, 4));
+  EXPECT_THAT(ch.query(3, 0), IsEmpty());
+  EXPECT_THAT(ch.query(2, 2), ElementsAre(2));
+  EXPECT_THAT(ch.query(0, 99), IsEmpty());
+  EXPECT_THAT(ContractionHierarchy().query(0, 3), IsEmpty());
+}
+
+TEST(ContractionHierarchy, NoPassThrough) {
+  // Shortest way from 0 to 2 is through 1, which may only be an endpoint
+  graph<long long, double> g;
+  for (long long i = 0; i < 4; i++) {
+    g.addVertex(i);
+  }
+  for (auto [u, v, w] : vector<tuple<long long, long long, double>>{
+           {0, 1, 1}, {1, 2, 1}, {0, 3, 5}, {3, 2, 5}}) {
+    g.addEdge(u, v, w);
+    g.addEdge(v, u, w);
+  }
+  ContractionHierarchy ch(g, {1});
+
+  EXPECT_THAT(ch.query(0, 2), ElementsAre(0, 3, 2));
+  EXPECT_THAT(ch.query(0, 1), ElementsAre(0, 1));
+  EXPECT_THAT(ch.query(1, 2), ElementsAre(1, 2));
+  EXPECT_THAT(ContractionHierarchy(g, {}).query(0, 2), ElementsAre(0, 1, 2));
+}
+
+TEST(ContractionHierarchy, MatchesDijkstra) {
+  const ContractedUicMap& m = contractedUicMap();
+  ASSERT_THAT(
+      m.ch.query(664275388, 151672203),
+      ElementsAreArray(dijkstra(m.G, 664275388, 151672203, m.buildingNodes)));
+
+  for (size_t i = 0; i < m.buildings.size(); i += 5) {
+    for (size_t j = 2; j < m.buildings.size(); j += 7) {
+      long long s = m.buildings[i].id;
+      long long t = m.buildings[j].id;
+      ASSERT_THAT(m.ch.query(s, t),
+                  ElementsAreArray(dijkstra(m.G, s, t, m.buildingNodes)))
+          << "CH disagrees from " << s << " to " << t;
+    }
+  }
+
+  // Between footway nodes, and in both directions
+  for (uint32_t u = 0; u < m.G.numVertices(); u += 541) {
+    for (uint32_t v = 17; v < m.G.numVertices(); v += 613) {
+      long long s = m.G.vertexAt(u);
+      long long t = m.G.vertexAt(v);
+      ASSERT_THAT(m.ch.query(s, t),
+                  ElementsAreArray(dijkstra(m.G, s, t, m.buildingNodes)))
+          << "CH disagrees from " << s << " to " << t;
+    }
+  }
+}
+
+TEST(ContractionHierarchy, BuildingsContractedFirst) {
+  const ContractedUicMap& m = contractedUicMap();
+  uint32_t buildings = 0;
+  for (long long id : m.buildingNodes) {
+    uint32_t i = m.G.indexOf(id);
+    if (i != frozen_graph<long long, double>::NONE) {
+      ASSERT_THAT(m.ch.rankOf(i), Lt(m.buildingNodes.size()));
+      buildings++;
+    }
+  }
+  EXPECT_THAT(buildings, Gt(0u));
+  EXPECT_THAT(m.ch.numShortcuts(), Gt(0u));
+}
@@ -9,7 +9,10 @@
 #include <vector>
 
 #include "application.h"
+#include "dijkstra_kernel.h"
+#include "frozen_graph.h"
 #include "graph.h"
+#include "indexed_heap.h"
 
 using namespace std;
 using namespace testing;
@@ -263,3 +266,293 @@ TEST(Dijkstra, FullSkipNodes) {
               ElementsAreArray(expectedErfToLcb))
       << "Wrong shortest path in UIC graph from ERF to LCB.";
 }
+
+TEST(Dijkstra, FrozenMatchesGraph) {
+  fillUicGraph();
+  frozen_graph<long long, double> frozen(UIC_GRAPH);
+
+  vector<pair<long long, long long>> queries = {
+      {664275388, 151676521},  // ARC -> SH
+      {151960667, 151676521},  // SEO -> SH
+      {664275388, 151672203},  // ARC -> LCB
+      {151960677, 151672203},  // ERF -> LCB
+  };
+  for (const auto& [start, target] : queries) {
+    vector<long long> expected =
+        dijkstra(UIC_GRAPH, start, target, BUILDING_NODES);
+    vector<long long> actual = dijkstra(frozen, start, target, BUILDING_NODES);
+    ASSERT_THAT(actual, ElementsAreArray(expected))
+        << "Frozen graph disagrees from " << start << " to " << target;
+    EXPECT_THAT(pathLength(frozen, actual),
+                DoubleEq(pathLength(UIC_GRAPH, expected)));
+  }
+
+  graph<long long, double> g = lineGraph(3);
+  frozen_graph<long long, double> line(g);
+  EXPECT_THAT(dijkstra(line, 0, 0, {}), ElementsAreArray({0}));
+  EXPECT_THAT(dijkstra(line, 2, 0, {}), IsEmpty());
+  EXPECT_THAT(dijkstra(line, 0, 2, {0, 2}), ElementsAreArray({0, 1, 2}));
+  EXPECT_THAT(dijkstra(line, 0, 99, {}), IsEmpty());
+}
+
+TEST(Dijkstra, ByIndex) {
+  graph<long long, double> g;
+  id_interner<long long> ids;
+  vector<BuildingInfo> buildings;
+  ifstream input("data/uic-fa24.osm.json");
+  buildGraph(input, g, buildings, ids);
+  frozen_graph<long long, double> frozen(g, ids);
+  set<long long> buildingNodes;
+  for (const auto& b : buildings) {
+    buildingNodes.insert(b.id);
+  }
+
+  long long seo = 151960667;
+  long long sh = 151676521;
+  vector<uint32_t> dense = dijkstraByIndex(frozen, ids.find(seo),
+                                           ids.find(sh), buildingNodes);
+  vector<long long> path;
+  for (uint32_t u : dense) {
+    path.push_back(ids.at(u));
+  }
+  ASSERT_THAT(path, ElementsAreArray(dijkstra(g, seo, sh, buildingNodes)));
+  EXPECT_THAT(pathLength(frozen, dense), DoubleNear(pathLength(g, path), 1e-12));
+  EXPECT_THAT(dijkstraByIndex(frozen, 0, frozen.NONE, {}), IsEmpty());
+}
+
+TEST(Dijkstra, ReusedWorkspace) {
+  fillUicGraph();
+  frozen_graph<long long, double> frozen(UIC_GRAPH);
+  SearchWorkspace workspace;
+
+  // Alternate queries so each one starts from the previous one's leftovers
+  vector<pair<long long, long long>> queries = {
+      {664275388, 151676521},  // ARC -> SH
+      {151960677, 151672203},  // ERF -> LCB
+      {151960667, 151676521},  // SEO -> SH
+      {664275388, 151672203},  // ARC -> LCB
+  };
+  for (int round = 0; round < 2; round++) {
+    for (const auto& [start, target] : queries) {
+      ASSERT_THAT(
+          dijkstra(frozen, start, target, BUILDING_NODES, workspace),
+          ElementsAreArray(dijkstra(UIC_GRAPH, start, target, BUILDING_NODES)))
+          << "Reused workspace disagrees from " << start << " to " << target;
+    }
+  }
+  EXPECT_THAT(workspace.capacity(), Eq(frozen.numVertices()));
+
+  // Ignored vertices from one query must not leak into the next, nor into a
+  // smaller graph sharing the workspace
+  graph<long long, double> g = lineGraph(3);
+  frozen_graph<long long, double> line(g);
+  EXPECT_THAT(dijkstra(line, 0, 2, {1}, workspace), IsEmpty());
+  EXPECT_THAT(dijkstra(line, 0, 2, {}, workspace), ElementsAreArray({0, 1, 2}));
+  EXPECT_THAT(dijkstra(line, 2, 0, {}, workspace), IsEmpty());
+  EXPECT_THAT(workspace.distance(0), Eq(SearchWorkspace::INF));
+}
+
+TEST(Dijkstra, OneToMany) {
+  fillUicGraph();
+  frozen_graph<long long, double> frozen(UIC_GRAPH);
+  long long arc = 664275388, seo = 151960667, sh = 151676521;
+  long long lcb = 151672203, erf = 151960677;
+
+  // Forward from one source matches separate point-to-point queries, even
+  // though the other targets are buildings that must not be passed through
+  vector<long long> targets = {sh, lcb, erf, seo};
+  vector<vector<long long>> forward = dijkstraOneToMany(
+      frozen, arc, targets, BUILDING_NODES, SearchDirection::Forward);
+  ASSERT_THAT(forward, SizeIs(targets.size()));
+  for (size_t i = 0; i < targets.size(); i++) {
+    EXPECT_THAT(forward[i], ElementsAreArray(dijkstra(UIC_GRAPH, arc, targets[i],
+                                                      BUILDING_NODES)))
+        << "Forward path to " << targets[i];
+  }
+
+  // Backward from the meeting point gives each person's path to it
+  vector<vector<long long>> backward = dijkstraOneToMany(
+      frozen, lcb, {arc, erf}, BUILDING_NODES, SearchDirection::Backward);
+  ASSERT_THAT(backward, SizeIs(2));
+  for (auto [path, from] : {make_pair(backward[0], arc),
+                            make_pair(backward[1], erf)}) {
+    vector<long long> expected = dijkstra(UIC_GRAPH, from, lcb, BUILDING_NODES);
+    ASSERT_THAT(path, Not(IsEmpty()));
+    EXPECT_THAT(path.front(), Eq(from));
+    EXPECT_THAT(path.back(), Eq(lcb));
+    EXPECT_THAT(pathLength(frozen, path),
+                DoubleNear(pathLength(UIC_GRAPH, expected), 1e-12));
+  }
+
+  // Edge cases: source as a target, unknown and unreachable targets
+  graph<long long, double> g = lineGraph(3);
+  frozen_graph<long long, double> line(g);
+  EXPECT_THAT(dijkstraOneToMany(line, 0, {0, 2, 99}, {1},
+                                SearchDirection::Forward),
+              ElementsAre(ElementsAre(0), IsEmpty(), IsEmpty()));
+  EXPECT_THAT(dijkstraOneToMany(line, 2, {0, 1}, {}, SearchDirection::Backward),
+              ElementsAre(ElementsAre(0, 1, 2), ElementsAre(1, 2)));
+  EXPECT_THAT(dijkstraOneToMany(line, 2, {0}, {}, SearchDirection::Forward),
+              ElementsAre(IsEmpty()));
+}
+
+TEST(Dijkstra, VertexMask) {
+  fillUicGraph();
+  frozen_graph<long long, double> frozen(UIC_GRAPH);
+  VertexMask mask(frozen, BUILDING_NODES);
+  ASSERT_THAT(mask.size(), Eq(frozen.numVertices()));
+  EXPECT_THAT(mask.count(), Eq(BUILDING_NODES.size()));
+  for (long long id : BUILDING_NODES) {
+    EXPECT_TRUE(mask.test(frozen.indexOf(id)));
+  }
+  EXPECT_FALSE(mask.test(frozen.NONE));
+
+  // Same paths as the set overloads for building-to-building queries
+  vector<long long> ids(BUILDING_NODES.begin(), BUILDING_NODES.end());
+  SearchWorkspace workspace;
+  for (size_t i = 0; i < ids.size(); i += 5) {
+    for (size_t j = 1; j < ids.size(); j += 7) {
+      ASSERT_THAT(dijkstra(frozen, ids[i], ids[j], mask, workspace),
+                  ElementsAreArray(
+                      dijkstra(frozen, ids[i], ids[j], BUILDING_NODES)))
+          << "Mask disagrees from " << ids[i] << " to " << ids[j];
+    }
+  }
+
+  uint32_t lcb = frozen.indexOf(151672203);
+  vector<uint32_t> starts = {frozen.indexOf(664275388),
+                             frozen.indexOf(151960677)};
+  EXPECT_THAT(dijkstraOneToManyByIndex(frozen, lcb, starts, mask,
+                                       SearchDirection::Backward, workspace),
+              ElementsAreArray(dijkstraOneToManyByIndex(
+                  frozen, lcb, starts, BUILDING_NODES,
+                  SearchDirection::Backward, workspace)));
+
+  // Endpoints may be excluded; the middle vertex blocks the only path
+  graph<long long, double> g = lineGraph(3);
+  frozen_graph<long long, double> line(g);
+  VertexMask ends(line, {0, 2});
+  EXPECT_THAT(dijkstra(line, 0, 2, ends), ElementsAre(0, 1, 2));
+  VertexMask middle(line);
+  middle.assign(1, true);
+  EXPECT_THAT(dijkstra(line, 0, 2, middle), IsEmpty());
+  EXPECT_THAT(dijkstra(line, 0, 1, middle), ElementsAre(0, 1));
+  middle.assign(1, false);
+  EXPECT_THAT(middle.count(), Eq(0u));
+}
+
+TEST(Dijkstra, PolicyKernel) {
+  fillUicGraph();
+  frozen_graph<long long, double> frozen(UIC_GRAPH);
+  size_t n = frozen.numVertices();
+  uint32_t arc = frozen.indexOf(664275388);
+  uint32_t sh = frozen.indexOf(151676521);
+  VertexMask buildings(frozen, BUILDING_NODES);
+
+  // Distance-only and full trees agree on every distance
+  SearchWorkspace full(n), bare(n);
+  shortestPathTree(frozen, arc, BUILDING_NODES, full);
+  ExploreAll everything;
+  dijkstraSearch(frozen, arc, bare, bare.heap(), ExcludeMask{buildings},
+                 everything, DistancesOnly());
+  for (uint32_t v = 0; v < n; v++) {
+    ASSERT_THAT(bare.distance(v), Eq(full.distance(v))) << "Vertex " << v;
+  }
+
+  // Another queue type settles vertices in the same order
+  SearchWorkspace binary(n);
+  indexed_heap<double, 2> queue;
+  StopAtTarget toSh{sh};
+  dijkstraSearch(frozen, arc, binary, queue, ExcludeMask{buildings}, toSh,
+                 RecordPredecessors());
+  vector<uint32_t> path;
+  for (uint32_t at = sh; at != arc; at = binary.predecessor(at)) {
+    path.insert(path.begin(), at);
+  }
+  path.insert(path.begin(), arc);
+  EXPECT_THAT(path, ElementsAreArray(dijkstraByIndex(frozen, arc, sh,
+                                                     BUILDING_NODES)));
+
+  // Backward without exclusions: distance to `arc` from everywhere
+  SearchWorkspace reverse(n);
+  dijkstraSearch<SearchDirection::Backward>(frozen, arc, reverse,
+                                            reverse.heap(), NoExclusion(),
+                                            everything, DistancesOnly());
+  EXPECT_THAT(reverse.distance(sh),
+              DoubleNear(pathLength(frozen, dijkstraByIndex(frozen, sh, arc,
+                                                            {})),
+                         1e-12));
+}
+
+TEST(Dijkstra, ShortestDistance) {
+  fillUicGraph();
+  frozen_graph<long long, double> frozen(UIC_GRAPH);
+  VertexMask mask(frozen, BUILDING_NODES);
+
+  // Sums the same edges in the same order as pathLength, so exactly equal
+  vector<long long> ids(BUILDING_NODES.begin(), BUILDING_NODES.end());
+  for (size_t i = 0; i < ids.size(); i += 4) {
+    for (size_t j = 2; j < ids.size(); j += 9) {
+      vector<long long> path = dijkstra(frozen, ids[i], ids[j], BUILDING_NODES);
+      double expected =
+          path.empty() ? SearchWorkspace::INF : pathLength(frozen, path);
+      ASSERT_THAT(shortestDistance(frozen, ids[i], ids[j], BUILDING_NODES),
+                  Eq(expected))
+          << "From " << ids[i] << " to " << ids[j];
+      ASSERT_THAT(shortestDistance(frozen, ids[i], ids[j], mask), Eq(expected));
+    }
+  }
+
+  graph<long long, double> g = lineGraph(3);
+  frozen_graph<long long, double> line(g);
+  EXPECT_THAT(shortestDistance(line, 0, 0, {}), Eq(0));
+  EXPECT_THAT(shortestDistance(line, 0, 2, {}), Eq(3));
+  EXPECT_THAT(shortestDistance(line, 0, 2, {0, 2}), Eq(3));
+  EXPECT_THAT(shortestDistance(line, 0, 2, {1}), Eq(SearchWorkspace::INF));
+  EXPECT_THAT(shortestDistance(line, 2, 0, {}), Eq(SearchWorkspace::INF));
+  EXPECT_THAT(shortestDistance(line, 0, 99, {}), Eq(SearchWorkspace::INF));
+}
+
+TEST(Dijkstra, SearchStats) {
+  fillUicGraph();
+  frozen_graph<long long, double> frozen(UIC_GRAPH);
+  long long arc = 664275388, sh = 151676521;
+
+  // Same paths with and without instrumentation
+  SearchStats hashStats;
+  EXPECT_THAT(dijkstra(UIC_GRAPH, arc, sh, BUILDING_NODES, hashStats),
+              ElementsAreArray(dijkstra(UIC_GRAPH, arc, sh, BUILDING_NODES)));
+  EXPECT_THAT(hashStats.settled, Gt(0u));
+  EXPECT_THAT(hashStats.pops, Eq(hashStats.settled + hashStats.stalePops));
+  EXPECT_THAT(hashStats.pushes, Ge(hashStats.pops));
+  EXPECT_THAT(hashStats.relaxed, Ge(hashStats.pushes - 1));
+  EXPECT_THAT(hashStats.maxHeapSize, Gt(0u));
+  EXPECT_THAT(hashStats.milliseconds, Ge(0));
+
+  // The indexed heap never holds stale entries, and both searches settle
+  // the same vertices
+  SearchStats stats;
+  EXPECT_THAT(dijkstra(frozen, arc, sh, BUILDING_NODES, stats),
+              ElementsAreArray(dijkstra(frozen, arc, sh, BUILDING_NODES)));
+  EXPECT_THAT(stats.stalePops, Eq(0u));
+  EXPECT_THAT(stats.pops, Eq(stats.settled));
+  EXPECT_THAT(stats.settled, Eq(hashStats.settled));
+  EXPECT_THAT(stats.maxHeapSize, Le(frozen.numVertices()));
+
+  // Counts add up over several searches
+  SearchStats once = stats;
+  dijkstra(frozen, arc, sh, BUILDING_NODES, stats);
+  EXPECT_THAT(stats.settled, Eq(2 * once.settled));
+  EXPECT_THAT(stats.relaxed, Eq(2 * once.relaxed));
+  EXPECT_THAT(stats.maxHeapSize, Eq(once.maxHeapSize));
+
+  SearchStats many;
+  SearchWorkspace workspace;
+  VertexMask mask(frozen, BUILDING_NODES);
+  vector<vector<uint32_t>> paths = dijkstraOneToManyByIndex(
+      frozen, frozen.indexOf(sh), {frozen.indexOf(arc)}, mask,
+      SearchDirection::Backward, workspace, many);
+  ASSERT_THAT(paths, SizeIs(1));
+  EXPECT_THAT(paths[0], Not(IsEmpty()));
+  EXPECT_THAT(many.settled, Gt(0u));
+}
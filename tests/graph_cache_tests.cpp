@@ -0,0 +1,189 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "application.h"
+#include "building_matrix.h"
+#include "frozen_graph.h"
+#include "graph.h"
+#include "graph_cache.h"
+
+using namespace std;
+using namespace testing;
+
+namespace fs = std::filesystem;
+
+struct BuiltMap {
+  frozen_graph<long long, double> G;
+  vector<BuildingInfo> buildings;
+  vector<Coordinates> coords;
+};
+
+BuiltMap buildMap(const string& filename) {
+  BuiltMap m;
+  graph<long long, double> g;
+  id_interner<long long> ids;
+  ifstream input(filename);
+  buildGraph(input, g, m.buildings, ids, m.coords);
+  m.G = frozen_graph<long long, double>(g, ids);
+  return m;
+}
+
+string tempPath(const string& name) {
+  return (fs::temp_directory_path() / ("osm_cache_test_" + name)).string();
+}
+
+TEST(GraphCache, RoundTrip) {
+  string source = "data/uic-fa24.osm.json";
+  string cache = tempPath("roundtrip.bin");
+  BuiltMap built = buildMap(source);
+  ASSERT_THAT(writeGraphCache(cache, source, built.G, built.buildings,
+                              built.coords),
+              IsTrue());
+
+  BuiltMap loaded;
+  ASSERT_THAT(loadGraphCache(cache, source, loaded.G, loaded.buildings,
+                             loaded.coords),
+              IsTrue());
+  fs::remove(cache);
+
+  ASSERT_THAT(loaded.G.numVertices(), Eq(built.G.numVertices()));
+  ASSERT_THAT(loaded.G.numEdges(), Eq(built.G.numEdges()));
+  ASSERT_THAT(loaded.buildings, ElementsAreArray(built.buildings));
+  ASSERT_THAT(loaded.coords.size(), Eq(built.coords.size()));
+  for (uint32_t u = 0; u < built.G.numVertices(); u++) {
+    ASSERT_THAT(loaded.G.vertexAt(u), Eq(built.G.vertexAt(u)));
+    ASSERT_THAT(loaded.coords[u].lat, Eq(built.coords[u].lat));
+    ASSERT_THAT(loaded.coords[u].lon, Eq(built.coords[u].lon));
+    ASSERT_THAT(loaded.G.edgeBegin(u), Eq(built.G.edgeBegin(u)));
+    ASSERT_THAT(loaded.G.edgeEnd(u), Eq(built.G.edgeEnd(u)));
+  }
+  for (uint32_t e = 0; e < built.G.numEdges(); e++) {
+    ASSERT_THAT(loaded.G.edgeTarget(e), Eq(built.G.edgeTarget(e)));
+    ASSERT_THAT(loaded.G.edgeWeight(e), Eq(built.G.edgeWeight(e)));
+  }
+
+  set<long long> buildingNodes;
+  for (const auto& b : built.buildings) {
+    buildingNodes.insert(b.id);
+  }
+  EXPECT_THAT(dijkstra(loaded.G, 664275388, 151676521, buildingNodes),
+              ElementsAreArray(
+                  dijkstra(built.G, 664275388, 151676521, buildingNodes)));
+}
+
+TEST(GraphCache, StaleSource) {
+  string source = tempPath("stale.json");
+  string cache = tempPath("stale.bin");
+  fs::copy_file("data/small_buildings.json", source,
+                fs::copy_options::overwrite_existing);
+  BuiltMap built = buildMap(source);
+  ASSERT_THAT(writeGraphCache(cache, source, built.G, built.buildings,
+                              built.coords),
+              IsTrue());
+
+  BuiltMap loaded;
+  ASSERT_THAT(loadGraphCache(cache, source, loaded.G, loaded.buildings,
+                             loaded.coords),
+              IsTrue());
+
+  // Same size, different content
+  {
+    fstream f(source, ios::in | ios::out | ios::binary);
+    f.seekp(0);
+    f.put(' ');
+  }
+  EXPECT_THAT(loadGraphCache(cache, source, loaded.G, loaded.buildings,
+                             loaded.coords),
+              IsFalse())
+      << "Cache should be rejected once the source JSON changes";
+  EXPECT_THAT(loadGraphCache(cache, "data/line.json", loaded.G,
+                             loaded.buildings, loaded.coords),
+              IsFalse())
+      << "Cache should be rejected for a different source";
+  fs::remove(source);
+  fs::remove(cache);
+}
+
+TEST(GraphCache, CorruptOrMissing) {
+  string source = "data/small_buildings.json";
+  string cache = tempPath("corrupt.bin");
+  BuiltMap loaded;
+  fs::remove(cache);
+  EXPECT_THAT(loadGraphCache(cache, source, loaded.G, loaded.buildings,
+                             loaded.coords),
+              IsFalse());
+
+  BuiltMap built = buildMap(source);
+  ASSERT_THAT(writeGraphCache(cache, source, built.G, built.buildings,
+                              built.coords),
+              IsTrue());
+  size_t size = fs::file_size(cache);
+
+  // Flip a payload byte
+  {
+    fstream f(cache, ios::in | ios::out | ios::binary);
+    f.seekg(size - 1);
+    char c = f.get();
+    f.seekp(size - 1);
+    f.put(c ^ 0x5a);
+  }
+  EXPECT_THAT(loadGraphCache(cache, source, loaded.G, loaded.buildings,
+                             loaded.coords),
+              IsFalse());
+
+  // Truncate
+  fs::resize_file(cache, size / 2);
+  EXPECT_THAT(loadGraphCache(cache, source, loaded.G, loaded.buildings,
+                             loaded.coords),
+              IsFalse());
+  EXPECT_THAT(loaded.G.numVertices(), Eq(0))
+      << "Outputs should be untouched when loading fails";
+  fs::remove(cache);
+}
+
+TEST(GraphCache, BuildingMatrixRoundTrip) {
+  BuiltMap built = buildMap("data/uic-fa24.osm.json");
+  BuildingMatrix matrix(built.G, built.buildings, 4);
+  string path = tempPath("matrix.bin");
+  ASSERT_THAT(writeBuildingMatrix(path, built.G, built.buildings, matrix),
+              IsTrue());
+
+  BuildingMatrix loaded;
+  ASSERT_THAT(loadBuildingMatrix(path, built.G, built.buildings, loaded),
+              IsTrue());
+  EXPECT_THAT(loaded.vertices(), ElementsAreArray(matrix.vertices()));
+  EXPECT_THAT(loaded.distanceTable(), ElementsAreArray(matrix.distanceTable()));
+  EXPECT_THAT(loaded.nextHopTable(), ElementsAreArray(matrix.nextHopTable()));
+
+  // A different catalog or graph invalidates the table
+  vector<BuildingInfo> fewer(built.buildings.begin() + 1,
+                             built.buildings.end());
+  BuildingMatrix untouched;
+  EXPECT_THAT(loadBuildingMatrix(path, built.G, fewer, untouched), IsFalse());
+  vector<BuildingInfo> swapped = built.buildings;
+  swap(swapped[0], swapped[1]);
+  EXPECT_THAT(loadBuildingMatrix(path, built.G, swapped, untouched),
+              IsFalse());
+  graph<long long, double> g;
+  g.addVertex(1);
+  EXPECT_THAT(loadBuildingMatrix(path, frozen_graph<long long, double>(g),
+                                 built.buildings, untouched),
+              IsFalse());
+  EXPECT_THAT(untouched.numBuildings(), Eq(0u));
+
+  // Corruption is caught by the payload hash
+  {
+    fstream f(path, ios::in | ios::out | ios::binary);
+    f.seekp(-3, ios::end);
+    f.put('\x7f');
+  }
+  EXPECT_THAT(loadBuildingMatrix(path, built.G, built.buildings, untouched),
+              IsFalse());
+  fs::remove(path);
+}
@@ -3,9 +3,14 @@
 
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "flat_hash_map.h"
+#include "frozen_graph.h"
 #include "graph.h"
+#include "id_interner.h"
+#include "indexed_heap.h"
 
 using namespace std;
 using namespace testing;
@@ -177,6 +182,26 @@ TEST(Graph, NeighborsStress) {
   ASSERT_THAT(actualVertices, UnorderedElementsAreArray(expectedVertices));
 }
 
+TEST(Graph, ForEachOutEdge) {
+  graph<int, int> g;
+  tournamentGraph(5, g);
+  if (HasFatalFailure()) return;
+
+  for (int i = 0; i < 5; i++) {
+    vector<pair<int, int>> edges;
+    g.forEachOutEdge(i, [&](int to, int weight) { edges.emplace_back(to, weight); });
+    vector<pair<int, int>> expected;
+    for (int j : g.neighbors(i)) {
+      expected.emplace_back(j, i);
+    }
+    ASSERT_THAT(edges, UnorderedElementsAreArray(expected));
+  }
+
+  int calls = 0;
+  g.forEachOutEdge(42, [&](int, int) { calls++; });
+  ASSERT_THAT(calls, Eq(0)) << "Missing vertex should have no out-edges";
+}
+
 TEST(Graph, DefaultCopies) {
   graph<int, int> g;
   completeGraph(4, g);
@@ -252,3 +277,210 @@ TEST(Graph, BigCompleteGraph) {
     }
   }
 }
+
+TEST(Graph, FrozenSnapshot) {
+  graph<int, int> g;
+  tournamentGraph(6, g);
+  if (HasFatalFailure()) return;
+  g.addVertex(100);
+
+  frozen_graph<int, int> f(g);
+  ASSERT_THAT(f.numVertices(), Eq(g.numVertices()));
+  ASSERT_THAT(f.numEdges(), Eq(g.numEdges()));
+
+  int expected, actual;
+  for (int i : g.getVertices()) {
+    uint32_t u = f.indexOf(i);
+    ASSERT_THAT(u, Ne(f.NONE));
+    ASSERT_THAT(f.vertexAt(u), Eq(i));
+    ASSERT_THAT(f.edgeEnd(u) - f.edgeBegin(u), Eq(g.neighbors(i).size()));
+    for (int j : g.getVertices()) {
+      bool exists = g.getWeight(i, j, expected);
+      ASSERT_THAT(f.getWeight(i, j, actual), Eq(exists));
+      if (exists) {
+        ASSERT_THAT(actual, Eq(expected));
+      }
+    }
+  }
+  ASSERT_THAT(f.indexOf(-1), Eq(f.NONE));
+  ASSERT_THAT(f.getWeight(-1, 0, actual), IsFalse());
+
+  // The snapshot is independent of later edits
+  g.addEdge(0, 5, 42);
+  ASSERT_THAT(f.getWeight(0, 5, actual), IsFalse());
+}
+
+TEST(Graph, IdInterner) {
+  id_interner<long long> ids;
+  ASSERT_THAT(ids.intern(11139567102LL), Eq(0));
+  ASSERT_THAT(ids.intern(7), Eq(1));
+  ASSERT_THAT(ids.intern(11139567102LL), Eq(0))
+      << "Re-interning an id should return its existing index";
+  ASSERT_THAT(ids.size(), Eq(2));
+  ASSERT_THAT(ids.find(7), Eq(1));
+  ASSERT_THAT(ids.find(8), Eq(ids.NONE));
+  ASSERT_THAT(ids.at(0), Eq(11139567102LL));
+  ASSERT_THAT(ids.values(), ElementsAre(11139567102LL, 7));
+
+  graph<long long, int> g;
+  g.addVertex(7);
+  g.addVertex(11139567102LL);
+  g.addVertex(3);
+  g.addEdge(7, 3, 1);
+  frozen_graph<long long, int> f(g, ids);
+  ASSERT_THAT(f.indexOf(11139567102LL), Eq(0))
+      << "Frozen graph should keep the interner's numbering";
+  ASSERT_THAT(f.indexOf(7), Eq(1));
+  ASSERT_THAT(f.indexOf(3), Eq(2))
+      << "Vertices missing from the interner are numbered after it";
+  int weight;
+  ASSERT_THAT(f.getWeightAt(1, 2, weight), IsTrue());
+  ASSERT_THAT(weight, Eq(1));
+}
+
+TEST(Graph, FlatHashMap) {
+  flat_hash_map<long long, int> m;
+  ASSERT_THAT(m.find(1) == m.end(), IsTrue());
+  int N = 10000;
+  for (int i = 0; i < N; i++) {
+    m[11139567102LL + i] = i;
+  }
+  ASSERT_THAT(m.size(), Eq(N));
+  ASSERT_THAT(m.try_emplace(11139567102LL).second, IsFalse())
+      << "Existing key should not be re-inserted";
+  for (int i = 0; i < N; i++) {
+    auto it = m.find(11139567102LL + i);
+    ASSERT_THAT(it != m.end(), IsTrue());
+    ASSERT_THAT(it->second, Eq(i));
+  }
+  ASSERT_THAT(m.find(0) == m.end(), IsTrue());
+  ASSERT_THROW(m.at(0), out_of_range);
+
+  long long sum = 0;
+  size_t visited = 0;
+  for (const auto& [k, v] : m) {
+    sum += v;
+    visited++;
+  }
+  ASSERT_THAT(visited, Eq(N));
+  ASSERT_THAT(sum, Eq((long long)N * (N - 1) / 2));
+}
+
+TEST(Graph, FlatStorage) {
+  graph<string, int, flat_hash_storage> g;
+  ASSERT_THAT(g.addVertex("0"), IsTrue());
+  ASSERT_THAT(g.addVertex("1"), IsTrue());
+  ASSERT_THAT(g.addVertex("1"), IsFalse());
+  ASSERT_THAT(g.addEdge("0", "1", 2), IsTrue());
+  ASSERT_THAT(g.addEdge("0", "1", 3), IsTrue());
+  ASSERT_THAT(g.addEdge("0", "missing", 3), IsFalse());
+  ASSERT_THAT(g.numEdges(), Eq(1));
+
+  int weight;
+  ASSERT_THAT(g.getWeight("0", "1", weight), IsTrue());
+  ASSERT_THAT(weight, Eq(3));
+  ASSERT_THAT(g.getWeight("1", "0", weight), IsFalse());
+  ASSERT_THAT(g.neighbors("0"), ElementsAre("1"));
+
+  int N = 300;
+  graph<int, int, flat_hash_storage> big;
+  graph<int, int> reference;
+  for (int i = 0; i < N; i++) {
+    big.addVertex(i);
+    reference.addVertex(i);
+  }
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j += 1 + i % 7) {
+      big.addEdge(i, j, i * j);
+      reference.addEdge(i, j, i * j);
+    }
+  }
+  ASSERT_THAT(big.numVertices(), Eq(reference.numVertices()));
+  ASSERT_THAT(big.numEdges(), Eq(reference.numEdges()));
+  ASSERT_THAT(big.getVertices(),
+              UnorderedElementsAreArray(reference.getVertices()));
+  for (int i = 0; i < N; i++) {
+    ASSERT_THAT(big.neighbors(i), ElementsAreArray(reference.neighbors(i)));
+  }
+
+  frozen_graph<int, int> fromFlat(big);
+  frozen_graph<int, int> fromNode(reference);
+  ASSERT_THAT(fromFlat.numEdges(), Eq(fromNode.numEdges()));
+}
+
+TEST(Graph, BulkAddEdges) {
+  graph<int, int> g;
+  g.reserve(4, 8);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_THAT(g.addVertex(i), IsTrue());
+  }
+  ASSERT_THAT(g.addEdge(0, 1, 100), IsTrue());
+
+  vector<tuple<int, int, int>> edges = {
+      {2, 3, 1}, {0, 1, 5}, {3, 2, 1}, {0, 2, 7},
+      {2, 3, 9},  // duplicate: last occurrence wins
+      {0, 9, 1},  // missing `to`
+      {9, 0, 1},  // missing `from`
+  };
+  ASSERT_THAT(g.addEdges(edges), Eq(4));
+  ASSERT_THAT(g.numEdges(), Eq(4)) << "Overwrites should not be counted";
+
+  int weight;
+  ASSERT_THAT(g.getWeight(0, 1, weight), IsTrue());
+  ASSERT_THAT(weight, Eq(5)) << "Bulk insert should overwrite existing edges";
+  ASSERT_THAT(g.getWeight(0, 2, weight), IsTrue());
+  ASSERT_THAT(weight, Eq(7));
+  ASSERT_THAT(g.getWeight(2, 3, weight), IsTrue());
+  ASSERT_THAT(weight, Eq(9));
+  ASSERT_THAT(g.getWeight(3, 2, weight), IsTrue());
+  ASSERT_THAT(weight, Eq(1));
+  ASSERT_THAT(g.getWeight(0, 9, weight), IsFalse());
+
+  graph<int, int, flat_hash_storage> flat;
+  flat.reserve(4, 8);
+  for (int i = 0; i < 4; i++) {
+    flat.addVertex(i);
+  }
+  flat.addEdge(0, 1, 100);
+  ASSERT_THAT(flat.addEdges(edges), Eq(4));
+  ASSERT_THAT(flat.numEdges(), Eq(4));
+  ASSERT_THAT(flat.getWeight(2, 3, weight), IsTrue());
+  ASSERT_THAT(weight, Eq(9));
+}
+
+TEST(Graph, IndexedHeap) {
+  indexed_heap<double> heap;
+  heap.reserve(8);
+  EXPECT_THAT(heap.empty(), IsTrue());
+
+  vector<double> keys = {5, 3, 8, 1, 9, 2, 7, 3};
+  for (uint32_t v = 0; v < keys.size(); v++) {
+    EXPECT_THAT(heap.pushOrDecrease(v, keys[v]), IsTrue());
+  }
+  EXPECT_THAT(heap.size(), Eq(8u));
+
+  // Decrease-key moves an entry up; a larger key is ignored
+  EXPECT_THAT(heap.pushOrDecrease(4, 0.5), IsTrue());
+  EXPECT_THAT(heap.pushOrDecrease(2, 10), IsFalse());
+  EXPECT_THAT(heap.size(), Eq(8u));
+  EXPECT_THAT(heap.top(), Pair(0.5, 4u));
+
+  // Ties break on the vertex, like a priority_queue of pairs
+  vector<pair<double, uint32_t>> popped;
+  while (!heap.empty()) {
+    popped.push_back(heap.pop());
+  }
+  EXPECT_THAT(popped, ElementsAre(Pair(0.5, 4u), Pair(1, 3u), Pair(2, 5u),
+                                  Pair(3, 1u), Pair(3, 7u), Pair(5, 0u),
+                                  Pair(7, 6u), Pair(8, 2u)));
+
+  // Leftover positions from before clear() don't count as membership
+  heap.pushOrDecrease(6, 1);
+  heap.pushOrDecrease(2, 4);
+  heap.clear();
+  EXPECT_THAT(heap.contains(6), IsFalse());
+  heap.pushOrDecrease(2, 3);
+  EXPECT_THAT(heap.contains(2), IsTrue());
+  EXPECT_THAT(heap.contains(6), IsFalse());
+  EXPECT_THAT(heap.pop(), Pair(3, 2u));
+}
@@ -0,0 +1,101 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "application.h"
+#include "frozen_graph.h"
+#include "graph.h"
+#include "landmarks.h"
+
+using namespace std;
+using namespace testing;
+
+struct LandmarkUicMap {
+  frozen_graph<long long, double> G;
+  vector<BuildingInfo> buildings;
+  set<long long> buildingNodes;
+  Landmarks landmarks;
+};
+
+// Loaded once; parsing the full map is slow under the sanitizers
+static const LandmarkUicMap& landmarkUicMap() {
+  static LandmarkUicMap m = [] {
+    LandmarkUicMap m;
+    graph<long long, double> g;
+    ifstream input("data/uic-fa24.osm.json");
+    buildGraph(input, g, m.buildings);
+    m.G = frozen_graph<long long, double>(g);
+    for (const auto& b : m.buildings) {
+      m.buildingNodes.insert(b.id);
+    }
+    m.landmarks = Landmarks(m.G, 8, 4);
+    return m;
+  }();
+  return m;
+}
+
+TEST(Landmarks, LowerBoundsAdmissible) {
+  const LandmarkUicMap& m = landmarkUicMap();
+  ASSERT_THAT(m.landmarks.vertices, SizeIs(8));
+  ASSERT_THAT(set<uint32_t>(m.landmarks.vertices.begin(),
+                            m.landmarks.vertices.end()),
+              SizeIs(8));
+  ASSERT_THAT(m.landmarks.covers(m.G.numVertices()), IsTrue());
+
+  for (uint32_t u = 0; u < m.G.numVertices(); u++) {
+    for (uint32_t e = m.G.edgeBegin(u); e < m.G.edgeEnd(u); e++) {
+      ASSERT_THAT(m.landmarks.lowerBound(u, m.G.edgeTarget(e)),
+                  Le(m.G.edgeWeight(e)))
+          << "Bound must never overestimate an edge";
+    }
+  }
+  EXPECT_THAT(m.landmarks.lowerBound(5, 5), Eq(0));
+}
+
+TEST(Landmarks, MatchesDijkstra) {
+  const LandmarkUicMap& m = landmarkUicMap();
+  for (size_t i = 0; i < m.buildings.size(); i += 7) {
+    for (size_t j = 3; j < m.buildings.size(); j += 11) {
+      long long s = m.buildings[i].id;
+      long long t = m.buildings[j].id;
+      vector<long long> expected = dijkstra(m.G, s, t, m.buildingNodes);
+      vector<long long> actual =
+          altSearch(m.G, m.landmarks, s, t, m.buildingNodes);
+      ASSERT_THAT(actual, ElementsAreArray(expected))
+          << "ALT disagrees from " << s << " to " << t;
+    }
+  }
+
+  EXPECT_THAT(altSearch(m.G, m.landmarks, 664275388, 664275388, {}),
+              ElementsAre(664275388));
+  EXPECT_THAT(altSearch(m.G, m.landmarks, 664275388, -1, {}), IsEmpty());
+}
+
+TEST(Landmarks, SmallGraph) {
+  // A detour around a "rail line": 0 and 3 are close but only connected
+  // through 1 and 2
+  graph<long long, double> g;
+  for (long long i = 0; i < 5; i++) {
+    g.addVertex(i);
+  }
+  for (auto [u, v, w] : vector<tuple<long long, long long, double>>{
+           {0, 1, 2}, {1, 2, 2}, {2, 3, 2}, {0, 4, 1}}) {
+    g.addEdge(u, v, w);
+    g.addEdge(v, u, w);
+  }
+  frozen_graph<long long, double> f(g);
+  Landmarks landmarks(f, 2);
+  ASSERT_THAT(landmarks.vertices, SizeIs(2));
+  EXPECT_THAT(landmarks.lowerBound(f.indexOf(0), f.indexOf(3)),
+              DoubleNear(6, 1e-6));
+  EXPECT_THAT(altSearch(f, landmarks, 0, 3, {}), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(altSearch(f, landmarks, 4, 3, {1}), IsEmpty());
+
+  // More landmarks than vertices: stops once every vertex is one
+  EXPECT_THAT(Landmarks(f, 10).vertices, SizeIs(5));
+  EXPECT_THAT(Landmarks(f, 0).covers(5), IsFalse());
+}
@@ -0,0 +1,170 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "application.h"
+#include "frozen_graph.h"
+#include "graph.h"
+#include "search_workspace.h"
+
+using namespace std;
+using namespace testing;
+
+// Footway 0-1-2-3-4 with unit edges, and buildings 10, 12 and 14 hanging
+// off 0, 2 and 4
+static frozen_graph<long long, double> campusLine(
+    vector<BuildingInfo>& buildings) {
+  graph<long long, double> g;
+  for (long long v : {0, 1, 2, 3, 4, 10, 12, 14}) {
+    g.addVertex(v);
+  }
+  for (auto [u, v, w] : vector<tuple<long long, long long, double>>{
+           {0, 1, 1}, {1, 2, 1}, {2, 3, 1}, {3, 4, 1},
+           {0, 10, 0.5}, {2, 12, 0.5}, {4, 14, 0.5}}) {
+    g.addEdge(u, v, w);
+    g.addEdge(v, u, w);
+  }
+  buildings = {BuildingInfo(10, Coordinates(), "West", "W"),
+               BuildingInfo(12, Coordinates(), "Middle", "M"),
+               BuildingInfo(14, Coordinates(), "East", "E")};
+  return frozen_graph<long long, double>(g);
+}
+
+TEST(MeetingPoint, Objectives) {
+  vector<BuildingInfo> buildings;
+  frozen_graph<long long, double> G = campusLine(buildings);
+  set<long long> buildingNodes = {10, 12, 14};
+
+  // Two people in the west building, one in the east
+  vector<SearchWorkspace> trees(3);
+  shortestPathTree(G, G.indexOf(10), buildingNodes, trees[0]);
+  shortestPathTree(G, G.indexOf(10), buildingNodes, trees[1]);
+  shortestPathTree(G, G.indexOf(14), buildingNodes, trees[2]);
+  EXPECT_THAT(trees[2].distance(G.indexOf(10)), DoubleEq(5));
+  EXPECT_THAT(trees[2].distance(G.indexOf(12)), DoubleEq(3));
+
+  EXPECT_THAT(chooseMeetingBuilding(G, buildings, trees, MeetingPoint::MinSum),
+              Eq(0));
+  EXPECT_THAT(chooseMeetingBuilding(G, buildings, trees, MeetingPoint::MinMax),
+              Eq(1));
+
+  vector<uint32_t> path = treePath(trees[2], G.indexOf(12));
+  vector<long long> ids;
+  for (uint32_t u : path) {
+    ids.push_back(G.vertexAt(u));
+  }
+  EXPECT_THAT(ids, ElementsAre(14, 4, 3, 2, 12));
+
+  // Nobody can reach a building that is cut off
+  graph<long long, double> g;
+  g.addVertex(10);
+  g.addVertex(12);
+  frozen_graph<long long, double> apart(g);
+  vector<SearchWorkspace> split(2);
+  shortestPathTree(apart, apart.indexOf(10), {}, split[0]);
+  shortestPathTree(apart, apart.indexOf(12), {}, split[1]);
+  EXPECT_THAT(chooseMeetingBuilding(apart, buildings, split,
+                                    MeetingPoint::MinMax),
+              Eq(-1));
+  EXPECT_THAT(treePath(split[0], apart.indexOf(12)), IsEmpty());
+
+  MeetingPoint parsed;
+  EXPECT_THAT(parseMeetingPoint("minsum", parsed), IsTrue());
+  EXPECT_THAT(parsed, Eq(MeetingPoint::MinSum));
+  EXPECT_THAT(parseMeetingPoint("nearest", parsed), IsFalse());
+}
+
+TEST(MeetingPoint, PlanForGroup) {
+  vector<BuildingInfo> buildings;
+  frozen_graph<long long, double> G = campusLine(buildings);
+  set<long long> buildingNodes = {10, 12, 14};
+  vector<uint32_t> group = {G.indexOf(10), G.indexOf(14), G.indexOf(10),
+                            G.indexOf(2), G.indexOf(10)};
+
+  vector<SearchWorkspace> trees;
+  for (unsigned threads : {1u, 4u}) {
+    MeetupPlan minSum = planMeetup(G, buildings, group, buildingNodes,
+                                   MeetingPoint::MinSum, trees, threads);
+    ASSERT_THAT(minSum.building, Eq(0));
+    ASSERT_THAT(minSum.paths, SizeIs(group.size()));
+    ASSERT_THAT(trees, SizeIs(group.size()));
+    for (size_t i = 0; i < group.size(); i++) {
+      EXPECT_THAT(minSum.paths[i].front(), Eq(group[i]));
+      EXPECT_THAT(minSum.paths[i].back(), Eq(G.indexOf(10)));
+    }
+
+    MeetupPlan minMax = planMeetup(G, buildings, group, buildingNodes,
+                                   MeetingPoint::MinMax, trees, threads);
+    EXPECT_THAT(minMax.building, Eq(1));
+    EXPECT_THAT(minMax.paths[3], ElementsAre(G.indexOf(2), G.indexOf(12)));
+  }
+
+  // A participant off the map leaves nowhere everyone can reach
+  group.push_back(frozen_graph<long long, double>::NONE);
+  MeetupPlan none = planMeetup(G, buildings, group, buildingNodes,
+                               MeetingPoint::MinMax, trees, 2);
+  EXPECT_THAT(none.building, Eq(-1));
+  EXPECT_THAT(none.paths, IsEmpty());
+}
+
+TEST(MeetingPoint, CenterOfPoints) {
+  Coordinates a(41.87, -87.65), b(41.88, -87.64), c(41.86, -87.66);
+  Coordinates two = centerOfPoints({a, b});
+  EXPECT_THAT(two.lat, DoubleEq(centerBetween2Points(a, b).lat));
+  EXPECT_THAT(two.lon, DoubleEq(centerBetween2Points(a, b).lon));
+  Coordinates three = centerOfPoints({a, b, c});
+  EXPECT_THAT(three.lat, DoubleNear(41.87, 1e-4));
+  EXPECT_THAT(three.lon, DoubleNear(-87.65, 1e-4));
+  EXPECT_THAT(centerOfPoints({c}).lat, Eq(c.lat));
+}
+
+TEST(MeetingPoint, MatchesPointToPoint) {
+  graph<long long, double> g;
+  vector<BuildingInfo> buildings;
+  ifstream input("data/uic-fa24.osm.json");
+  buildGraph(input, g, buildings);
+  frozen_graph<long long, double> G(g);
+  set<long long> buildingNodes;
+  for (const auto& b : buildings) {
+    buildingNodes.insert(b.id);
+  }
+
+  long long arc = 664275388, seo = 151960667;
+  vector<SearchWorkspace> trees(2);
+  shortestPathTree(G, G.indexOf(arc), buildingNodes, trees[0]);
+  shortestPathTree(G, G.indexOf(seo), buildingNodes, trees[1]);
+
+  // Tree paths are exactly dijkstra's, and the choice beats every building
+  // scored with separate queries
+  double bestMax = SearchWorkspace::INF, bestSum = SearchWorkspace::INF;
+  for (const BuildingInfo& b : buildings) {
+    uint32_t v = G.indexOf(b.id);
+    vector<uint32_t> fromArc = dijkstraByIndex(G, G.indexOf(arc), v,
+                                               buildingNodes);
+    vector<uint32_t> fromSeo = dijkstraByIndex(G, G.indexOf(seo), v,
+                                               buildingNodes);
+    ASSERT_THAT(treePath(trees[0], v), ElementsAreArray(fromArc));
+    ASSERT_THAT(treePath(trees[1], v), ElementsAreArray(fromSeo));
+    if (!fromArc.empty() && !fromSeo.empty()) {
+      double a = pathLength(G, fromArc), s = pathLength(G, fromSeo);
+      bestMax = min(bestMax, max(a, s));
+      bestSum = min(bestSum, a + s);
+    }
+  }
+
+  int minMax = chooseMeetingBuilding(G, buildings, trees, MeetingPoint::MinMax);
+  int minSum = chooseMeetingBuilding(G, buildings, trees, MeetingPoint::MinSum);
+  ASSERT_THAT(minMax, Ge(0));
+  ASSERT_THAT(minSum, Ge(0));
+  uint32_t mm = G.indexOf(buildings[minMax].id);
+  uint32_t ms = G.indexOf(buildings[minSum].id);
+  EXPECT_THAT(max(trees[0].distance(mm), trees[1].distance(mm)),
+              DoubleNear(bestMax, 1e-12));
+  EXPECT_THAT(trees[0].distance(ms) + trees[1].distance(ms),
+              DoubleNear(bestSum, 1e-12));
+}
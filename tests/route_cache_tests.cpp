@@ -0,0 +1,148 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "application.h"
+#include "frozen_graph.h"
+#include "graph.h"
+#include "route_cache.h"
+
+using namespace std;
+using namespace testing;
+
+// 0 -> 1 -> 2 -> 3 with weights 1, 2, 3, plus a slower detour 0 -> 3
+static graph<long long, double> detourGraph() {
+  graph<long long, double> g;
+  for (int i = 0; i < 4; i++) {
+    g.addVertex(i);
+  }
+  g.addEdge(0, 1, 1);
+  g.addEdge(1, 2, 2);
+  g.addEdge(2, 3, 3);
+  g.addEdge(0, 3, 10);
+  return g;
+}
+
+TEST(RouteCache, HitsAndMisses) {
+  graph<long long, double> g = detourGraph();
+  RouteCache cache(8);
+
+  RouteCache::Route first = cache.route(g, 0, 3, {});
+  EXPECT_THAT(first.path, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(first.length, DoubleEq(6));
+  EXPECT_THAT(cache.misses(), Eq(1u));
+  EXPECT_THAT(cache.hits(), Eq(0u));
+
+  RouteCache::Route again = cache.route(g, 0, 3, {});
+  EXPECT_THAT(again.path, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(cache.hits(), Eq(1u));
+
+  // A different ignore set is a different query
+  RouteCache::Route detour = cache.route(g, 0, 3, {1});
+  EXPECT_THAT(detour.path, ElementsAre(0, 3));
+  EXPECT_THAT(detour.length, DoubleEq(10));
+  EXPECT_THAT(cache.misses(), Eq(2u));
+
+  RouteCache::Route none = cache.route(g, 3, 0, {});
+  EXPECT_THAT(none.path, IsEmpty());
+  EXPECT_THAT(none.length, Eq(-1));
+  cache.route(g, 3, 0, {});
+  EXPECT_THAT(cache.hits(), Eq(2u));
+  EXPECT_THAT(cache.size(), Eq(3u));
+}
+
+TEST(RouteCache, EvictsLeastRecentlyUsed) {
+  graph<long long, double> g = detourGraph();
+  RouteCache cache(2);
+
+  cache.route(g, 0, 1, {});
+  cache.route(g, 0, 2, {});
+  cache.route(g, 0, 1, {});  // hit; 0 -> 2 is now the oldest
+  cache.route(g, 0, 3, {});  // evicts 0 -> 2
+  EXPECT_THAT(cache.size(), Eq(2u));
+  EXPECT_THAT(cache.hits(), Eq(1u));
+
+  cache.route(g, 0, 1, {});
+  EXPECT_THAT(cache.hits(), Eq(2u));
+  cache.route(g, 0, 2, {});
+  EXPECT_THAT(cache.hits(), Eq(2u));
+  EXPECT_THAT(cache.misses(), Eq(4u));
+
+  cache.clear();
+  EXPECT_THAT(cache.size(), Eq(0u));
+}
+
+TEST(RouteCache, InvalidatedWhenGraphChanges) {
+  graph<long long, double> g = detourGraph();
+  RouteCache cache(8);
+
+  EXPECT_THAT(cache.route(g, 0, 3, {}).length, DoubleEq(6));
+
+  uint64_t before = g.version();
+  g.addEdge(0, 3, 4);
+  EXPECT_THAT(g.version(), Ne(before));
+  RouteCache::Route shorter = cache.route(g, 0, 3, {});
+  EXPECT_THAT(shorter.path, ElementsAre(0, 3));
+  EXPECT_THAT(shorter.length, DoubleEq(4));
+  EXPECT_THAT(cache.hits(), Eq(0u));
+  EXPECT_THAT(cache.size(), Eq(1u));
+
+  // Failed changes keep the version
+  before = g.version();
+  EXPECT_FALSE(g.addVertex(0));
+  EXPECT_FALSE(g.addEdge(0, 99, 1));
+  EXPECT_THAT(g.version(), Eq(before));
+
+  // A snapshot is a different graph; its copies are the same one
+  frozen_graph<long long, double> G(g);
+  frozen_graph<long long, double> copy = G;
+  EXPECT_THAT(copy.version(), Eq(G.version()));
+  EXPECT_THAT(G.version(), Ne(g.version()));
+  cache.route(G, 0, 3, {});
+  cache.route(copy, 0, 3, {});
+  EXPECT_THAT(cache.hits(), Eq(1u));
+}
+
+TEST(RouteCache, SharedBetweenThreads) {
+  graph<long long, double> g;
+  vector<BuildingInfo> buildings;
+  ifstream input("data/uic-fa24.osm.json");
+  buildGraph(input, g, buildings);
+  frozen_graph<long long, double> G(g);
+  set<long long> buildingNodes;
+  for (const auto& b : buildings) {
+    buildingNodes.insert(b.id);
+  }
+
+  RouteCache cache(16);
+  vector<thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&] {
+      for (int round = 0; round < 3; round++) {
+        for (size_t i = 0; i + 1 < 10; i++) {
+          cache.route(G, buildings[i].id, buildings[i + 1].id, buildingNodes);
+        }
+      }
+    });
+  }
+  for (thread& t : threads) {
+    t.join();
+  }
+  EXPECT_THAT(cache.hits() + cache.misses(), Eq(4u * 3 * 9));
+  EXPECT_THAT(cache.size(), Eq(9u));
+
+  for (size_t i = 0; i + 1 < 10; i++) {
+    RouteCache::Route cached =
+        cache.route(G, buildings[i].id, buildings[i + 1].id, buildingNodes);
+    vector<long long> fresh =
+        dijkstra(G, buildings[i].id, buildings[i + 1].id, buildingNodes);
+    ASSERT_THAT(cached.path, Eq(fresh));
+    if (!fresh.empty()) {
+      ASSERT_THAT(cached.length, DoubleEq(pathLength(G, fresh)));
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/// @brief Fixed set of worker threads that stay alive between jobs, so a
+///        stream of short batches does not pay for thread creation each
+///        time (unlike `parallelFor`). A job is one callable run once on
+///        every worker, given the worker's number; workers split the work
+///        among themselves, e.g. by pulling items off a shared atomic counter.
+///        Only one job runs at a time.
+class ThreadPool {
+ public:
+  /// @brief Start `threads` workers (at least 1).
+  explicit ThreadPool(unsigned threads) {
+    unsigned n = max(threads, 1u);
+    workers.reserve(n);
+    for (unsigned i = 0; i < n; i++) {
+      workers.emplace_back([this, i] { workerLoop(i); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      lock_guard<mutex> lock(m);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (thread& t : workers) {
+      t.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// @brief Number of workers.
+  unsigned size() const {
+    return workers.size();
+  }
+
+  /// @brief Run `job(worker)` on every worker and wait for all of them. If a
+  ///        worker throws, the first exception is rethrown here once the
+  ///        others have finished.
+  void run(const function<void(unsigned)>& job) {
+    unique_lock<mutex> lock(m);
+    current = &job;
+    running = workers.size();
+    error = nullptr;
+    generation++;
+    wake.notify_all();
+    done.wait(lock, [this] { return running == 0; });
+    current = nullptr;
+    if (error) {
+      rethrow_exception(error);
+    }
+  }
+
+ private:
+  vector<thread> workers;
+  mutex m;
+  condition_variable wake;
+  condition_variable done;
+  const function<void(unsigned)>* current = nullptr;
+  uint64_t generation = 0;
+  size_t running = 0;
+  bool stopping = false;
+  exception_ptr error;
+
+  void workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    while (true) {
+      const function<void(unsigned)>* job;
+      {
+        unique_lock<mutex> lock(m);
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) {
+          return;
+        }
+        seen = generation;
+        job = current;
+      }
+
+      exception_ptr thrown;
+      try {
+        (*job)(worker);
+      } catch (...) {
+        thrown = current_exception();
+      }
+
+      lock_guard<mutex> lock(m);
+      if (thrown && !error) {
+        error = thrown;
+      }
+      if (--running == 0) {
+        done.notify_one();
+      }
+    }
+  }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "frozen_graph.h"
+
+using namespace std;
+
+/// @brief One bit per dense vertex index, e.g. the vertices a search must
+///        not pass through. Testing a vertex is a shift and a mask instead
+///        of a tree lookup in a `set<long long>`, and the whole mask for a
+///        graph of V vertices takes V / 8 bytes, so it can be built once
+///        when the graph is loaded and shared by every query.
+class VertexMask {
+ public:
+  // No size-only or default constructor: a braced `{}` or `{id}` argument
+  // must keep meaning a `set<long long>` in the search overloads
+
+  /// @brief Mask over the vertices of `G`, none set.
+  template <typename VertexT, typename WeightT>
+  explicit VertexMask(const frozen_graph<VertexT, WeightT>& G)
+      : words((G.numVertices() + 63) / 64, 0), bits(G.numVertices()) {
+  }
+
+  /// @brief Mask over the vertices of `G` with the listed node IDs set.
+  ///        IDs that are not in `G` are skipped.
+  template <typename VertexT, typename WeightT>
+  VertexMask(const frozen_graph<VertexT, WeightT>& G,
+             const set<VertexT>& vertices)
+      : VertexMask(G) {
+    for (const VertexT& v : vertices) {
+      uint32_t i = G.indexOf(v);
+      if (i != frozen_graph<VertexT, WeightT>::NONE) {
+        assign(i, true);
+      }
+    }
+  }
+
+  /// @brief Number of vertices the mask covers.
+  size_t size() const {
+    return bits;
+  }
+
+  /// @brief Whether `v` is set; false for indices past `size()`.
+  bool test(uint32_t v) const {
+    return v < bits && (words[v >> 6] >> (v & 63)) & 1;
+  }
+
+  /// @brief Set or clear `v`, which must be below `size()`.
+  void assign(uint32_t v, bool value) {
+    uint64_t bit = uint64_t(1) << (v & 63);
+    if (value) {
+      words[v >> 6] |= bit;
+    } else {
+      words[v >> 6] &= ~bit;
+    }
+  }
+
+  /// @brief Number of vertices set. O(V / 64).
+  size_t count() const {
+    size_t total = 0;
+    for (uint64_t w : words) {
+      total += popcount(w);
+    }
+    return total;
+  }
+
+ private:
+  vector<uint64_t> words;
+  size_t bits = 0;
+};